@@ -26,6 +26,7 @@ static crispy_t crispy_s = {
 	.extautomap = 1,
 	.extsaveg = 1,
 	.hires = 1,
+	.renderthreads = 1,
 	.smoothscaling = 1,
 	.soundfix = 1,
 	.vsync = 1,
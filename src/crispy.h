@@ -54,6 +54,7 @@ typedef struct
 	int extautomap;
 	int extsaveg;
 	int flipcorpses;
+	int framebudget;
 	int freeaim;
 	int freelook;
 	int hires;
@@ -65,6 +66,7 @@ typedef struct
 	int pitch;
 	int playercoords;
 	int recoil;
+	int renderthreads;
 	int secretmessage;
 	int smoothlight;
 	int smoothscaling;
@@ -95,6 +97,7 @@ typedef struct
 	boolean havessg;
 	boolean singleplayer;
 	boolean stretchsky;
+	boolean touchingthings;
 
 	const char *sdlversion;
 	const char *platform;
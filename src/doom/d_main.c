@@ -51,6 +51,7 @@
 #include "m_controls.h"
 #include "m_misc.h"
 #include "m_menu.h"
+#include "m_savefile.h" // [crispy] savegame_compression
 #include "p_saveg.h"
 
 #include "i_endoom.h"
@@ -72,6 +73,7 @@
 
 #include "p_setup.h"
 #include "r_local.h"
+#include "r_stats.h" // [crispy] -renderstats
 #include "statdump.h"
 
 
@@ -391,6 +393,7 @@ void D_BindVariables(void)
     // [crispy] unconditionally disable savegame and demo limits
 //  M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
 //  M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("savegame_compression",   &savegame_compression);
     M_BindIntVariable("show_endoom",            &show_endoom);
     M_BindIntVariable("show_diskicon",          &show_diskicon);
 
@@ -423,6 +426,7 @@ void D_BindVariables(void)
     M_BindIntVariable("crispy_extautomap",      &crispy->extautomap);
     M_BindIntVariable("crispy_extsaveg",        &crispy->extsaveg);
     M_BindIntVariable("crispy_flipcorpses",     &crispy->flipcorpses);
+    M_BindIntVariable("crispy_framebudget",     &crispy->framebudget);
     M_BindIntVariable("crispy_freeaim",         &crispy->freeaim);
     M_BindIntVariable("crispy_freelook",        &crispy->freelook);
     M_BindIntVariable("crispy_hires",           &crispy->hires);
@@ -434,6 +438,7 @@ void D_BindVariables(void)
     M_BindIntVariable("crispy_pitch",           &crispy->pitch);
     M_BindIntVariable("crispy_playercoords",    &crispy->playercoords);
     M_BindIntVariable("crispy_recoil",          &crispy->recoil);
+    M_BindIntVariable("crispy_renderthreads",   &crispy->renderthreads);
     M_BindIntVariable("crispy_secretmessage",   &crispy->secretmessage);
     M_BindIntVariable("crispy_smoothlight",     &crispy->smoothlight);
     M_BindIntVariable("crispy_smoothscaling",   &crispy->smoothscaling);
@@ -519,7 +524,10 @@ void D_RunFrame()
             wipestart = I_GetTime () - 1;
         } else {
             // normal update
+            R_StartRenderPhase (); // [crispy] render statistics
             I_FinishUpdate ();              // page flip or blit buffer
+            R_EndRenderPhase (RSTAT_FINISH);
+            R_WriteRenderStats ();
         }
     }
 
@@ -1461,6 +1469,10 @@ static void LoadSigilWad(void)
             }
         }
 
+        // [crispy] regenerate the hashtable before looking up the same
+        // names again, so that the renamed lumps are not found
+        W_GenerateHashTable();
+
         // [crispy] rename intrusive SIGIL.wad graphics, demos and music lumps out of the way
         for (i = 0; i < arrlen(sigil_lumps); i++)
         {
@@ -2330,6 +2342,16 @@ void D_DoomMain (void)
         crispy->flipweapons = !crispy->flipweapons;
     }
 
+    //!
+    // @category game
+    //
+    // Moving floors and ceilings only re-check the things touching
+    // them. This is faster on large maps, but may change whether a
+    // door or lift reverses on things stuck nearby. Single player only.
+    //
+
+    crispy->touchingthings = M_ParmExists("-touchingthings");
+
     // Check for load game parameter
     // We do this here and save the slot number, so that the network code
     // can override it or send the load slot to other players.
@@ -2390,6 +2412,8 @@ void D_DoomMain (void)
         DEH_printf("External statistics registered.\n");
     }
 
+    R_InitRenderStats (); // [crispy] -renderstats
+
     //!
     // @arg <x>
     // @category demo
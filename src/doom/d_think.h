@@ -62,6 +62,10 @@ typedef struct thinker_s
     struct thinker_s*	prev;
     struct thinker_s*	next;
     think_t		function;
+
+    // [crispy] MBF-style per-class list, kept alongside the main list
+    struct thinker_s*	cprev;
+    struct thinker_s*	cnext;
     
 } thinker_t;
 
@@ -199,6 +199,9 @@ extern boolean lowres_turn;
 // Quit after playing a demo from cmdline.
 extern  boolean		singledemo;	
 
+// [crispy] Exit with a report when the demo finishes.
+extern  boolean		timingdemo;
+
 
 
 
@@ -1972,7 +1972,7 @@ void G_DoLoadGame (void)
     }
     gameaction = ga_nothing; 
 	 
-    save_stream = fopen(savename, "rb");
+    save_stream = M_SaveFileOpenRead(savename, SAVESTRINGSIZE);
 
     if (save_stream == NULL)
     {
@@ -1994,7 +1994,7 @@ void G_DoLoadGame (void)
             strcasecmp(savewadfilename, W_WadNameForLump(savemaplumpinfo)))
         {
             M_ForceLoadGame();
-            fclose(save_stream);
+            M_SaveFileClose(save_stream);
             return;
         }
         else
@@ -2013,7 +2013,7 @@ void G_DoLoadGame (void)
         // [crispy] indicate game version mismatch
         extern void M_LoadGameVerMismatch ();
         M_LoadGameVerMismatch();
-        fclose(save_stream);
+        M_SaveFileClose(save_stream);
         return;
     }
 
@@ -2041,7 +2041,8 @@ void G_DoLoadGame (void)
         P_ReadExtendedSaveGameData(1);
     }
 
-    fclose(save_stream);
+    M_SaveFileClose(save_stream);
+    P_ClearThinkerIndex(); // [crispy]
     
     if (setsizeneeded)
 	R_ExecuteSetViewSize ();
@@ -2089,14 +2090,14 @@ void G_DoSaveGame (void)
     // and then rename it at the end if it was successfully written.
     // This prevents an existing savegame from being overwritten by
     // a corrupted one, or if a savegame buffer overrun occurs.
-    save_stream = fopen(temp_savegame_file, "wb");
+    save_stream = M_SaveFileOpenWrite(temp_savegame_file, SAVESTRINGSIZE);
 
     if (save_stream == NULL)
     {
         // Failed to save the game, so we're going to have to abort. But
         // to be nice, save to somewhere else before we call I_Error().
         recovery_savegame_file = M_TempFile("recovery.dsg");
-        save_stream = fopen(recovery_savegame_file, "wb");
+        save_stream = M_SaveFileOpenWrite(recovery_savegame_file, SAVESTRINGSIZE);
         if (save_stream == NULL)
         {
             I_Error("Failed to open either '%s' or '%s' to write savegame.",
@@ -2137,7 +2138,7 @@ void G_DoSaveGame (void)
     // Enforce the same savegame size limit as in Vanilla Doom,
     // except if the vanilla_savegame_limit setting is turned off.
 
-    if (vanilla_savegame_limit && ftell(save_stream) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && M_SaveFileTell(save_stream) > SAVEGAMESIZE)
     {
         I_Error("Savegame buffer overrun");
     }
@@ -2145,7 +2146,25 @@ void G_DoSaveGame (void)
 
     // Finish up, close the savegame file.
 
-    fclose(save_stream);
+    if (!M_SaveFileClose(save_stream))
+    {
+        // [crispy] all writes are buffered, so an incomplete savegame
+        // only shows up here; keep the old one rather than replace it
+        fprintf(stderr, "G_DoSaveGame: Error while writing save game\n");
+        P_ClearThinkerIndex();
+
+        if (recovery_savegame_file != NULL)
+        {
+            I_Error("Failed to write savegame to either '%s' or '%s'.",
+                    temp_savegame_file, recovery_savegame_file);
+        }
+
+        remove(temp_savegame_file);
+        gameaction = ga_nothing;
+        players[consoleplayer].message = "Error: game not saved.";
+        return;
+    }
+    P_ClearThinkerIndex(); // [crispy]
 
     if (recovery_savegame_file != NULL)
     {
@@ -583,7 +583,7 @@ void A_KeenDie (mobj_t* mo)
     
     // scan the remaining thinkers
     // to see if all Keens are dead
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinkerclasscap[th_mobj].cnext ; th != &thinkerclasscap[th_mobj] ; th=th->cnext)
     {
 	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 	    continue;
@@ -1521,13 +1521,13 @@ A_PainShootSkull
     // count total number of skull currently on the level
     count = 0;
 
-    currentthinker = thinkercap.next;
-    while (currentthinker != &thinkercap)
+    currentthinker = thinkerclasscap[th_mobj].cnext;
+    while (currentthinker != &thinkerclasscap[th_mobj])
     {
 	if (   (currentthinker->function.acp1 == (actionf_p1)P_MobjThinker)
 	    && ((mobj_t *)currentthinker)->type == MT_SKULL)
 	    count++;
-	currentthinker = currentthinker->next;
+	currentthinker = currentthinker->cnext;
     }
 
     // if there are allready 20 skulls on the level,
@@ -1759,7 +1759,7 @@ void A_BossDeath (mobj_t* mo)
     
     // scan the remaining thinkers to see
     // if all bosses are dead
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinkerclasscap[th_mobj].cnext ; th != &thinkerclasscap[th_mobj] ; th=th->cnext)
     {
 	if (th->function.acp1 != (actionf_p1)P_MobjThinker)
 	    continue;
@@ -1899,10 +1899,10 @@ void A_BrainAwake (mobj_t* mo)
     numbraintargets = 0;
     braintargeton = 0;
 	
-    thinker = thinkercap.next;
-    for (thinker = thinkercap.next ;
-	 thinker != &thinkercap ;
-	 thinker = thinker->next)
+    thinker = thinkerclasscap[th_mobj].cnext;
+    for (thinker = thinkerclasscap[th_mobj].cnext ;
+	 thinker != &thinkerclasscap[th_mobj] ;
+	 thinker = thinker->cnext)
     {
 	if (thinker->function.acp1 != (actionf_p1)P_MobjThinker)
 	    continue;	// not a mobj
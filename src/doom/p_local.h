@@ -68,6 +68,17 @@
 // both the head and tail of the thinker list
 extern	thinker_t	thinkercap;	
 
+// [crispy] thinker classes, each with its own list in the same order
+// as the main list, so that scans for mobjs only touch mobjs
+typedef enum
+{
+    th_mobj,
+    th_misc,
+    NUMTHCLASS
+} thclass_t;
+
+extern	thinker_t	thinkerclasscap[NUMTHCLASS];
+
 
 void P_InitThinkers (void);
 void P_AddThinker (thinker_t* thinker);
@@ -199,6 +210,8 @@ P_PathTraverse
 
 void P_UnsetThingPosition (mobj_t* thing);
 void P_SetThingPosition (mobj_t* thing);
+void P_ClearSecNodes (void);
+boolean P_TouchingThings (void);
 
 
 //
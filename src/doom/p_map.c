@@ -1601,6 +1601,95 @@ boolean PIT_ChangeSector (mobj_t*	thing)
 
 
 
+//
+// [crispy] ChangeSectorTouching
+// Visit only the things touching the moving sector, in the order
+// the blockmap walk in P_ChangeSector() would have reached them.
+//
+typedef struct
+{
+    mobj_t*	thing;
+    int		block;	// column-major, as the blockmap walk goes
+} touchthing_t;
+
+static touchthing_t*	touchthings;
+static int		numtouchthings, maxtouchthings;
+
+static int CompareTouchThings (const void *a, const void *b)
+{
+    return ((const touchthing_t *) a)->block - ((const touchthing_t *) b)->block;
+}
+
+static void ChangeSectorTouching (sector_t* sector)
+{
+    msecnode_t*	node;
+    mobj_t*	thing;
+    touchthing_t	swap;
+    int		bx, by;
+    int		i, j, k, l;
+
+    numtouchthings = 0;
+
+    for (node = sector->touching_thinglist ; node ; node = node->m_snext)
+    {
+	thing = node->m_thing;
+	bx = (thing->x - bmaporgx)>>MAPBLOCKSHIFT;
+	by = (thing->y - bmaporgy)>>MAPBLOCKSHIFT;
+
+	// things linked into blocks outside the sector's
+	// blockbox (or none at all) are never visited
+	if (bx < sector->blockbox[BOXLEFT] || bx > sector->blockbox[BOXRIGHT]
+	    || by < sector->blockbox[BOXBOTTOM] || by > sector->blockbox[BOXTOP])
+	    continue;
+
+	if (numtouchthings == maxtouchthings)
+	{
+	    maxtouchthings = maxtouchthings ? 2 * maxtouchthings : 64;
+	    touchthings = I_Realloc(touchthings, maxtouchthings * sizeof(*touchthings));
+	}
+
+	touchthings[numtouchthings].thing = thing;
+	touchthings[numtouchthings].block = bx * bmapheight + by;
+	numtouchthings++;
+    }
+
+    qsort(touchthings, numtouchthings, sizeof(*touchthings), CompareTouchThings);
+
+    // things sharing a block go in the order of its list
+    for (i = 0 ; i < numtouchthings ; i = j)
+    {
+	for (j = i + 1 ; j < numtouchthings && touchthings[j].block == touchthings[i].block ; j++);
+
+	if (j - i < 2)
+	    continue;
+
+	bx = touchthings[i].block / bmapheight;
+	by = touchthings[i].block % bmapheight;
+
+	for (thing = blocklinks[by*bmapwidth+bx], k = i ; thing && k < j ; thing = thing->bnext)
+	    for (l = k ; l < j ; l++)
+		if (touchthings[l].thing == thing)
+		{
+		    swap = touchthings[l];
+		    touchthings[l] = touchthings[k];
+		    touchthings[k++] = swap;
+		    break;
+		}
+    }
+
+    for (i = 0 ; i < numtouchthings ; i++)
+    {
+	thing = touchthings[i].thing;
+
+	// removed (e.g. picked up) in the meantime, and thus
+	// already unlinked from its block
+	if (thing->thinker.function.acv == (actionf_v) (-1))
+	    continue;
+
+	PIT_ChangeSector (thing);
+    }
+}
+
 //
 // P_ChangeSector
 //
@@ -1614,6 +1703,16 @@ P_ChangeSector
 	
     nofit = false;
     crushchange = crunch;
+
+    // [crispy] vanilla also re-clips things near the sector that do
+    // not touch it, which may refresh their floorz or crush them if
+    // they are stuck, so this is only done on request, and never for
+    // demos and netgames
+    if (P_TouchingThings())
+    {
+	ChangeSectorTouching (sector);
+	return nofit;
+    }
 	
     // re-check heights for all things near the moving sector
     for (x=sector->blockbox[BOXLEFT] ; x<= sector->blockbox[BOXRIGHT] ; x++)
@@ -27,6 +27,7 @@
 
 #include "i_system.h" // [crispy] I_Realloc()
 #include "m_bbox.h"
+#include "z_zone.h" // [crispy] Z_Malloc()
 
 #include "doomdef.h"
 #include "doomstat.h"
@@ -333,6 +334,136 @@ void P_LineOpening (line_t* linedef)
 //
 
 
+//
+// [crispy] sector-to-thing touching lists, taken from Boom.
+// Every thing in the blockmap is linked to each sector that its bounding
+// box touches, so that moving sectors need only visit those things.
+// The lists are only kept with -touchingthings in single player, and
+// stay empty otherwise.
+//
+static msecnode_t*	headsecnode;	// free nodes, linked by m_tnext
+static boolean		secnodes;	// lists are complete for this level
+
+// forget the free nodes, they are freed with the level
+void P_ClearSecNodes (void)
+{
+    headsecnode = NULL;
+    secnodes = crispy->touchingthings && crispy->singleplayer;
+}
+
+// things are linked into the lists, and the lists are complete
+boolean P_TouchingThings (void)
+{
+    return secnodes && crispy->touchingthings && crispy->singleplayer;
+}
+
+static void P_AddSecnode (sector_t* sec, mobj_t* thing)
+{
+    msecnode_t*	node;
+
+    for (node = thing->touching_sectorlist ; node ; node = node->m_tnext)
+	if (node->m_sector == sec)
+	    return;	// already touching this sector
+
+    if (headsecnode)
+    {
+	node = headsecnode;
+	headsecnode = node->m_tnext;
+    }
+    else
+	node = Z_Malloc (sizeof(*node), PU_LEVEL, NULL);
+
+    node->m_sector = sec;
+    node->m_thing = thing;
+    node->m_tnext = thing->touching_sectorlist;
+    thing->touching_sectorlist = node;
+
+    node->m_sprev = NULL;
+    node->m_snext = sec->touching_thinglist;
+    if (sec->touching_thinglist)
+	sec->touching_thinglist->m_sprev = node;
+    sec->touching_thinglist = node;
+}
+
+static void P_DelSecnodes (mobj_t* thing)
+{
+    msecnode_t*	node;
+    msecnode_t*	next;
+
+    for (node = thing->touching_sectorlist ; node ; node = next)
+    {
+	next = node->m_tnext;
+
+	if (node->m_snext)
+	    node->m_snext->m_sprev = node->m_sprev;
+	if (node->m_sprev)
+	    node->m_sprev->m_snext = node->m_snext;
+	else
+	    node->m_sector->touching_thinglist = node->m_snext;
+
+	node->m_tnext = headsecnode;
+	headsecnode = node;
+    }
+
+    thing->touching_sectorlist = NULL;
+}
+
+// the same sectors P_CheckPosition() takes the heights from: the
+// thing's own, and those on both sides of lines crossing its box
+static void P_CreateSecnodes (mobj_t* thing)
+{
+    fixed_t	bbox[4];
+    int		xl, xh, yl, yh;
+    int		bx, by;
+    int32_t*	list;
+    line_t*	ld;
+
+    bbox[BOXTOP] = thing->y + thing->radius;
+    bbox[BOXBOTTOM] = thing->y - thing->radius;
+    bbox[BOXRIGHT] = thing->x + thing->radius;
+    bbox[BOXLEFT] = thing->x - thing->radius;
+
+    P_AddSecnode (thing->subsector->sector, thing);
+
+    xl = (bbox[BOXLEFT] - bmaporgx)>>MAPBLOCKSHIFT;
+    xh = (bbox[BOXRIGHT] - bmaporgx)>>MAPBLOCKSHIFT;
+    yl = (bbox[BOXBOTTOM] - bmaporgy)>>MAPBLOCKSHIFT;
+    yh = (bbox[BOXTOP] - bmaporgy)>>MAPBLOCKSHIFT;
+
+    if (xl < 0)
+	xl = 0;
+    if (yl < 0)
+	yl = 0;
+    if (xh >= bmapwidth)
+	xh = bmapwidth - 1;
+    if (yh >= bmapheight)
+	yh = bmapheight - 1;
+
+    // validcount is left alone, lines in several blocks are just
+    // checked again and their sectors are only added once
+    for (bx = xl ; bx <= xh ; bx++)
+	for (by = yl ; by <= yh ; by++)
+	    for (list = blockmaplump + blockmap[by*bmapwidth+bx] ; *list != -1 ; list++)
+	    {
+		ld = &lines[*list];
+
+		if (bbox[BOXRIGHT] <= ld->bbox[BOXLEFT]
+		    || bbox[BOXLEFT] >= ld->bbox[BOXRIGHT]
+		    || bbox[BOXTOP] <= ld->bbox[BOXBOTTOM]
+		    || bbox[BOXBOTTOM] >= ld->bbox[BOXTOP])
+		    continue;
+
+		if (P_BoxOnLineSide (bbox, ld) != -1)
+		    continue;
+
+		if (ld->frontsector)
+		    P_AddSecnode (ld->frontsector, thing);
+		if (ld->backsector)
+		    P_AddSecnode (ld->backsector, thing);
+	    }
+}
+
+
 //
 // P_UnsetThingPosition
 // Unlinks a thing from block map and sectors.
@@ -379,6 +510,10 @@ void P_UnsetThingPosition (mobj_t* thing)
 	    }
 	}
     }
+
+    // [crispy] unlink from the sectors it touches
+    if (thing->touching_sectorlist)
+	P_DelSecnodes (thing);
 }
 
 
@@ -442,6 +577,10 @@ P_SetThingPosition (mobj_t* thing)
 	    // thing is off the map
 	    thing->bnext = thing->bprev = NULL;
 	}
+
+	// [crispy] link into the sectors it touches
+	if (P_TouchingThings())
+	    P_CreateSecnodes (thing);
     }
 }
 
@@ -712,23 +851,31 @@ boolean PIT_AddThingIntercepts (mobj_t* thing)
 }
 
 
-//
-// P_TraverseIntercepts
-// Returns true if the traverser function returns true
-// for all lines.
-// 
-boolean
-P_TraverseIntercepts
+// [crispy] order intercepts by distance; for equal distances the
+// one added first wins, as with the original linear search
+static int CompareIntercepts (const void *a, const void *b)
+{
+    const intercept_t *ia = *(const intercept_t *const *) a;
+    const intercept_t *ib = *(const intercept_t *const *) b;
+
+    if (ia->frac != ib->frac)
+	return ia->frac < ib->frac ? -1 : 1;
+
+    return ia < ib ? -1 : ia > ib;
+}
+
+// [crispy] the original traversal, searching for the closest
+// intercept on every step
+static boolean
+TraverseInterceptsLinear
 ( traverser_t	func,
-  fixed_t	maxfrac )
+  fixed_t	maxfrac,
+  int		count )
 {
-    int			count;
     fixed_t		dist;
     intercept_t*	scan;
     intercept_t*	in;
 	
-    count = intercept_p - intercepts;
-    
     in = 0;			// shut up compiler warning
 	
     while (count--)
@@ -746,22 +893,67 @@ P_TraverseIntercepts
 	if (dist > maxfrac)
 	    return true;	// checked everything in range		
 
-#if 0  // UNUSED
+        if ( !func (in) )
+	    return false;	// don't bother going farther
+
+	in->frac = INT_MAX;
+    }
+	
+    return true;		// everything was traversed
+}
+
+//
+// P_TraverseIntercepts
+// Returns true if the traverser function returns true
+// for all lines.
+// 
+// [crispy] sort the intercepts once instead of searching
+// for the closest one on every step
+//
+boolean
+P_TraverseIntercepts
+( traverser_t	func,
+  fixed_t	maxfrac )
+{
+    static intercept_t**	order;
+    static int		num_order;
+    static int		traversals;
+    int			count;
+    int			serial;
+    int			i;
+    intercept_t*	in;
+	
+    count = intercept_p - intercepts;
+    serial = ++traversals;
+
+    if (count > num_order)
     {
-	// don't check these yet, there may be others inserted
-	in = scan = intercepts;
-	for ( scan = intercepts ; scan<intercept_p ; scan++)
-	    if (scan->frac > maxfrac)
-		*in++ = *scan;
-	intercept_p = in;
-	return false;
+	num_order = count * 2;
+	order = I_Realloc(order, sizeof(*order) * num_order);
     }
-#endif
+
+    for (i = 0 ; i < count ; i++)
+	order[i] = &intercepts[i];
+
+    qsort(order, count, sizeof(*order), CompareIntercepts);
+
+    for (i = 0 ; i < count ; i++)
+    {
+	in = order[i];
+
+	if (in->frac > maxfrac)
+	    return true;	// checked everything in range		
 
         if ( !func (in) )
 	    return false;	// don't bother going farther
 
 	in->frac = INT_MAX;
+
+	// [crispy] the traverser started a trace of its own (e.g. from
+	// a death state action), which has replaced the intercepts and
+	// the sorted order; carry on over what is left, as vanilla did
+	if (traversals != serial)
+	    return TraverseInterceptsLinear(func, maxfrac, count - i - 1);
     }
 	
     return true;		// everything was traversed
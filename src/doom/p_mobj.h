@@ -227,6 +227,9 @@ typedef struct mobj_s
     // Links in blocks (if needed).
     struct mobj_s*	bnext;
     struct mobj_s*	bprev;
+
+    // [crispy] links to the sectors the thing touches
+    struct msecnode_s*	touching_sectorlist;
     
     struct subsector_s*	subsector;
 
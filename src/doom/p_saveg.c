@@ -19,6 +19,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "dstrings.h"
 #include "deh_main.h"
@@ -33,11 +34,17 @@
 #include "m_misc.h"
 #include "r_state.h"
 
-FILE *save_stream;
+savefile_t *save_stream;
 int savegamelength;
 boolean savegame_error;
 static int restoretargets_fail;
 
+// [crispy] mobj index tables, valid while a game is being saved or loaded
+static thinker_t **thinkerindex;
+static uint32_t numthinkerindex, maxthinkerindex;
+static uint32_t *thinkerhash;
+static uint32_t thinkerhashmask;
+
 // Get the filename of a temporary file to write the savegame to.  After
 // the file has been successfully saved, it will be renamed to the 
 // real file.
@@ -78,9 +85,9 @@ char *P_SaveGameFile(int slot)
 
 static byte saveg_read8(void)
 {
-    byte result = -1;
+    int result;
 
-    if (fread(&result, 1, 1, save_stream) < 1)
+    if ((result = M_SaveFileGetc(save_stream)) == EOF)
     {
         if (!savegame_error)
         {
@@ -89,6 +96,8 @@ static byte saveg_read8(void)
 
             savegame_error = true;
         }
+
+        result = -1;
     }
 
     return result;
@@ -96,7 +105,7 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
+    if (M_SaveFilePutc(value, save_stream) == EOF)
     {
         if (!savegame_error)
         {
@@ -151,7 +160,7 @@ static void saveg_read_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = M_SaveFileTell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -167,7 +176,7 @@ static void saveg_write_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = M_SaveFileTell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -415,6 +424,65 @@ static void saveg_read_mobj_t(mobj_t *str)
 
     // struct mobj_s* tracer;
     str->tracer = saveg_readp();
+
+    // [crispy] rebuilt by P_SetThingPosition()
+    str->touching_sectorlist = NULL;
+}
+
+#define P_ThinkerHash(th) ((uint32_t) (((uintptr_t) (th) >> 4) * 2654435761u))
+
+// [crispy] number all mobjs once, in the order P_ThinkerToIndex() and
+// P_IndexToThinker() count them, so that each lookup is O(1) instead of
+// a walk of the whole mobj list
+void P_BuildThinkerIndex (void)
+{
+    thinker_t*	th;
+    uint32_t	i, h;
+
+    numthinkerindex = 0;
+
+    for (th = thinkerclasscap[th_mobj].cnext; th != &thinkerclasscap[th_mobj]; th = th->cnext)
+    {
+	if (th->function.acp1 == (actionf_p1) P_MobjThinker)
+	{
+	    if (numthinkerindex == maxthinkerindex)
+	    {
+		maxthinkerindex = maxthinkerindex ? 2 * maxthinkerindex : 1024;
+		thinkerindex = I_Realloc(thinkerindex, maxthinkerindex * sizeof(*thinkerindex));
+	    }
+
+	    thinkerindex[numthinkerindex++] = th;
+	}
+    }
+
+    // open-addressed hash of 1-based indices, at most half full
+    for (h = 1024; h < 2 * numthinkerindex; h <<= 1);
+
+    if (h - 1 != thinkerhashmask || !thinkerhash)
+    {
+	free(thinkerhash);
+	thinkerhash = malloc(h * sizeof(*thinkerhash));
+	thinkerhashmask = h - 1;
+    }
+
+    memset(thinkerhash, 0, h * sizeof(*thinkerhash));
+
+    for (i = 0; i < numthinkerindex; i++)
+    {
+	h = P_ThinkerHash(thinkerindex[i]) & thinkerhashmask;
+
+	while (thinkerhash[h])
+	    h = (h + 1) & thinkerhashmask;
+
+	thinkerhash[h] = i + 1;
+    }
+}
+
+void P_ClearThinkerIndex (void)
+{
+    numthinkerindex = 0;
+    free(thinkerhash);
+    thinkerhash = NULL;
 }
 
 // [crispy] enumerate all thinker pointers
@@ -426,7 +494,19 @@ uint32_t P_ThinkerToIndex (thinker_t* thinker)
     if (!thinker)
 	return 0;
 
-    for (th = thinkercap.next, i = 0; th != &thinkercap; th = th->next)
+    if (thinkerhash)
+    {
+	for (i = P_ThinkerHash(thinker) & thinkerhashmask; thinkerhash[i];
+	     i = (i + 1) & thinkerhashmask)
+	{
+	    if (thinkerindex[thinkerhash[i] - 1] == thinker)
+		return thinkerhash[i];
+	}
+
+	return 0;
+    }
+
+    for (th = thinkerclasscap[th_mobj].cnext, i = 0; th != &thinkerclasscap[th_mobj]; th = th->cnext)
     {
 	if (th->function.acp1 == (actionf_p1) P_MobjThinker)
 	{
@@ -448,7 +528,17 @@ thinker_t* P_IndexToThinker (uint32_t index)
     if (!index)
 	return NULL;
 
-    for (th = thinkercap.next, i = 0; th != &thinkercap; th = th->next)
+    if (thinkerhash)
+    {
+	if (index <= numthinkerindex)
+	    return thinkerindex[index - 1];
+
+	restoretargets_fail++;
+
+	return NULL;
+    }
+
+    for (th = thinkerclasscap[th_mobj].cnext, i = 0; th != &thinkerclasscap[th_mobj]; th = th->cnext)
     {
 	if (th->function.acp1 == (actionf_p1) P_MobjThinker)
 	{
@@ -1663,8 +1753,11 @@ void P_ArchiveThinkers (void)
 {
     thinker_t*		th;
 
+    // [crispy] number the mobjs for their target and tracer fields
+    P_BuildThinkerIndex();
+
     // save off the current thinkers
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinkerclasscap[th_mobj].cnext ; th != &thinkerclasscap[th_mobj] ; th=th->cnext)
     {
 	if (th->function.acp1 == (actionf_p1)P_MobjThinker)
 	{
@@ -1716,6 +1809,8 @@ void P_UnArchiveThinkers (void)
 	switch (tclass)
 	{
 	  case tc_end:
+	    // [crispy] number the mobjs for P_RestoreTargets()
+	    P_BuildThinkerIndex();
 	    return; 	// end of list
 			
 	  case tc_mobj:
@@ -1750,7 +1845,7 @@ void P_RestoreTargets (void)
     mobj_t*	mo;
     thinker_t*	th;
 
-    for (th = thinkercap.next; th != &thinkercap; th = th->next)
+    for (th = thinkerclasscap[th_mobj].cnext; th != &thinkerclasscap[th_mobj]; th = th->cnext)
     {
 	if (th->function.acp1 == (actionf_p1) P_MobjThinker)
 	{
@@ -1802,7 +1897,7 @@ void P_ArchiveSpecials (void)
     int			i;
 	
     // save off the current thinkers
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinkerclasscap[th_misc].cnext ; th != &thinkerclasscap[th_misc] ; th=th->cnext)
     {
 	if (th->function.acv == (actionf_v)NULL)
 	{
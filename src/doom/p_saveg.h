@@ -22,6 +22,8 @@
 
 #include <stdio.h>
 
+#include "m_savefile.h"
+
 #define SAVEGAME_EOF 0x1d
 #define VERSIONSIZE 16
 
@@ -58,8 +60,10 @@ void P_UnArchiveThinkers (void);
 void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 void P_RestoreTargets (void);
+void P_BuildThinkerIndex (void);
+void P_ClearThinkerIndex (void);
 
-extern FILE *save_stream;
+extern savefile_t *save_stream;
 extern boolean savegame_error;
 
 
@@ -1139,6 +1139,7 @@ P_SetupLevel
     musinfo.from_savegame = false;
 
     Z_FreeTags (PU_LEVEL, PU_PURGELEVEL-1);
+    P_ClearSecNodes ();
 
     // UNUSED W_Profile ();
     P_InitThinkers ();
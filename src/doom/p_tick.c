@@ -40,13 +40,23 @@ int	leveltime;
 // Both the head and tail of the thinker list.
 thinker_t	thinkercap;
 
+// [crispy] heads and tails of the thinker class lists
+thinker_t	thinkerclasscap[NUMTHCLASS];
+
 
 //
 // P_InitThinkers
 //
 void P_InitThinkers (void)
 {
+    int i;
+
     thinkercap.prev = thinkercap.next  = &thinkercap;
+
+    for (i = 0; i < NUMTHCLASS; i++)
+    {
+	thinkerclasscap[i].cprev = thinkerclasscap[i].cnext = &thinkerclasscap[i];
+    }
 }
 
 
@@ -58,10 +68,24 @@ void P_InitThinkers (void)
 //
 void P_AddThinker (thinker_t* thinker)
 {
+    thinker_t *cap;
+
     thinkercap.prev->next = thinker;
     thinker->next = &thinkercap;
     thinker->prev = thinkercap.prev;
     thinkercap.prev = thinker;
+
+    // [crispy] the specials only get their function assigned after
+    // they have been added, but mobjs always have theirs by now
+    if (thinker->function.acp1 == (actionf_p1)P_MobjThinker)
+	cap = &thinkerclasscap[th_mobj];
+    else
+	cap = &thinkerclasscap[th_misc];
+
+    cap->cprev->cnext = thinker;
+    thinker->cnext = cap;
+    thinker->cprev = cap->cprev;
+    cap->cprev = thinker;
 }
 
 
@@ -73,6 +97,15 @@ void P_AddThinker (thinker_t* thinker)
 //
 void P_RemoveThinker (thinker_t* thinker)
 {
+  // [crispy] already removed
+  if (thinker->function.acv == (actionf_v)(-1))
+    return;
+
+  // [crispy] unlink from its class list right away, but leave its own
+  // links intact so that a scan currently standing on it can go on
+  thinker->cnext->cprev = thinker->cprev;
+  thinker->cprev->cnext = thinker->cnext;
+
   // FIXME: NOP.
   thinker->function.acv = (actionf_v)(-1);
 }
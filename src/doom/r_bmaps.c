@@ -314,7 +314,7 @@ static byte hacxlightning[256] =
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 };
 
-byte *dc_brightmap = nobrightmap;
+THREADLOCAL byte *dc_brightmap = nobrightmap; // [crispy] per render thread
 
 // [crispy] brightmaps for textures
 
@@ -588,6 +588,47 @@ R_GetColumn
     return texturecomposite[tex] + ofs;
 }
 
+//
+// [crispy] R_LockComposite
+// Keep a composite from being purged while columns from it are queued
+// for drawing. R_GenerateComposite() may purge composites at any time.
+//
+static boolean*	compositelocked;
+static int*	lockedcomposites;
+static int	numlockedcomposites;
+
+void R_LockComposite (int tex)
+{
+    if (!compositelocked)
+    {
+	compositelocked = calloc(numtextures, sizeof(*compositelocked));
+	lockedcomposites = malloc(numtextures * sizeof(*lockedcomposites));
+    }
+
+    if (compositelocked[tex])
+	return;
+
+    compositelocked[tex] = true;
+    lockedcomposites[numlockedcomposites++] = tex;
+    Z_ChangeTag (texturecomposite[tex], PU_STATIC);
+}
+
+//
+// [crispy] R_UnlockComposites
+// Once the queued columns have been drawn.
+//
+void R_UnlockComposites (void)
+{
+    int		tex;
+
+    while (numlockedcomposites > 0)
+    {
+	tex = lockedcomposites[--numlockedcomposites];
+	compositelocked[tex] = false;
+	Z_ChangeTag (texturecomposite[tex], PU_CACHE);
+    }
+}
+
 
 static void GenerateTextureHashTable(void)
 {
@@ -1450,7 +1491,7 @@ void R_PrecacheLevel (void)
     spritepresent = Z_Malloc(numsprites, PU_STATIC, NULL);
     memset (spritepresent,0, numsprites);
 	
-    for (th = thinkercap.next ; th != &thinkercap ; th=th->next)
+    for (th = thinkerclasscap[th_mobj].cnext ; th != &thinkerclasscap[th_mobj] ; th=th->cnext)
     {
 	if (th->function.acp1 == (actionf_p1)P_MobjThinker)
 	    spritepresent[((mobj_t *)th)->sprite] = 1;
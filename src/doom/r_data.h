@@ -35,6 +35,9 @@ R_GetColumn
   int		col,
   boolean	opaque );
 
+void R_LockComposite (int tex); // [crispy]
+void R_UnlockComposites (void); // [crispy]
+
 
 // I/O, setting up the stuff.
 void R_InitData (void);
@@ -129,6 +129,9 @@ typedef	struct
     // list of mobjs in sector
     mobj_t*	thinglist;
 
+    // [crispy] list of mobjs that touch the sector
+    struct msecnode_s*	touching_thinglist;
+
     // thinker_t for reversable actions
     void*	specialdata;
 
@@ -164,6 +167,18 @@ typedef	struct
     short	oldspecial;
 } sector_t;
 
+// [crispy] taken from Boom: links a thing to every sector it touches,
+// both as an element of the thing's list of sectors and of the
+// sector's list of things
+typedef struct msecnode_s
+{
+    sector_t*		m_sector;	// a sector containing this object
+    mobj_t*		m_thing;	// this object
+    struct msecnode_s*	m_tnext;	// next msecnode_t for this thing
+    struct msecnode_s*	m_sprev;	// prev msecnode_t for this sector
+    struct msecnode_s*	m_snext;	// next msecnode_t for this sector
+} msecnode_t;
+
 
 
 
@@ -476,6 +491,7 @@ typedef struct
   int			lightlevel;
   int			minx;
   int			maxx;
+  int			next; // [crispy] index of next visplane in hash chain
   
   // leave pads for [minx-1]/[maxx+1]
   
@@ -25,6 +25,7 @@
 #include "deh_main.h"
 
 #include "i_system.h"
+#include "m_argv.h" // [crispy] M_ParmExists()
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -37,6 +38,13 @@
 // State.
 #include "doomstat.h"
 
+// [crispy] SIMD span drawers
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#define HAVE_AVX2_DRAWERS
+#include <immintrin.h>
+#endif
+
 
 // ?
 //#define MAXWIDTH			1120
@@ -79,17 +87,18 @@ static pixel_t *background_buffer = NULL;
 //
 // R_DrawColumn
 // Source is the top of the column to scale.
+// [crispy] Each render thread keeps its own column state.
 //
-lighttable_t*		dc_colormap[2]; // [crispy] brightmaps
-int			dc_x; 
-int			dc_yl; 
-int			dc_yh; 
-fixed_t			dc_iscale; 
-fixed_t			dc_texturemid;
-int			dc_texheight; // [crispy] Tutti-Frutti fix
+THREADLOCAL lighttable_t*	dc_colormap[2]; // [crispy] brightmaps
+THREADLOCAL int			dc_x; 
+THREADLOCAL int			dc_yl; 
+THREADLOCAL int			dc_yh; 
+THREADLOCAL fixed_t		dc_iscale; 
+THREADLOCAL fixed_t		dc_texturemid;
+THREADLOCAL int			dc_texheight; // [crispy] Tutti-Frutti fix
 
 // first pixel in a column (possibly virtual) 
-byte*			dc_source;		
+THREADLOCAL byte*		dc_source;		
 
 // just for profiling 
 int			dccount;
@@ -776,35 +785,70 @@ void R_InitTranslationTables (void)
 //  the texture at an angle in all but a few cases.
 // In consequence, flats are not stored by column (like walls),
 //  and the inner loop has to step in texture space u and v.
+// [crispy] Each render thread keeps its own span state.
 //
-int			ds_y; 
-int			ds_x1; 
-int			ds_x2;
+THREADLOCAL int			ds_y; 
+THREADLOCAL int			ds_x1; 
+THREADLOCAL int			ds_x2;
 
-lighttable_t*		ds_colormap[2];
-byte*			ds_brightmap;
+THREADLOCAL lighttable_t*		ds_colormap[2];
+THREADLOCAL byte*			ds_brightmap;
 
-fixed_t			ds_xfrac; 
-fixed_t			ds_yfrac; 
-fixed_t			ds_xstep; 
-fixed_t			ds_ystep;
+THREADLOCAL fixed_t			ds_xfrac; 
+THREADLOCAL fixed_t			ds_yfrac; 
+THREADLOCAL fixed_t			ds_xstep; 
+THREADLOCAL fixed_t			ds_ystep;
 
 // start of a 64*64 tile image 
-byte*			ds_source;	
+THREADLOCAL byte*			ds_source;	
 
 // just for profiling
 int			dscount;
 
 
 //
-// Draws the actual span.
-void R_DrawSpan (void) 
-{ 
-//  unsigned int position, step;
-    pixel_t *dest;
-    int count;
-    int spot;
-    unsigned int xtemp, ytemp;
+// [crispy] A span always covers adjacent screen columns (in reverse
+// order if the level is flipped), so the destination is stepped
+// directly instead of going through columnofs[] for every pixel.
+//
+static inline pixel_t *R_DrawSpanPixel (pixel_t *dest, int step, int spot, const int low)
+{
+    const byte source = ds_source[spot];
+    const pixel_t pixel = ds_colormap[ds_brightmap[source]][source];
+
+    *dest = pixel;
+    dest += step;
+
+    // Lowres/blocky mode does it twice.
+    if (low)
+    {
+	*dest = pixel;
+	dest += step;
+    }
+
+    return dest;
+}
+
+// Draw the pixels of a span one at a time.
+static inline void R_DrawSpanPixels (pixel_t *dest, int step, int count,
+                                     unsigned int xfrac, unsigned int yfrac,
+                                     const int low)
+{
+    while (count-- > 0)
+    {
+	const int spot = ((yfrac >> 10) & 0x0fc0) | ((xfrac >> 16) & 0x3f);
+
+	dest = R_DrawSpanPixel(dest, step, spot, low);
+
+	xfrac += ds_xstep;
+	yfrac += ds_ystep;
+    }
+}
+
+// First pixel of the span and the distance between two pixels.
+static inline pixel_t *R_SpanDest (int *step, const int low)
+{
+    const int x = ds_x1 << low;
 
 #ifdef RANGECHECK
     if (ds_x2 < ds_x1
@@ -815,46 +859,23 @@ void R_DrawSpan (void)
 	I_Error( "R_DrawSpan: %i to %i at %i",
 		 ds_x1,ds_x2,ds_y);
     }
-//	dscount++;
 #endif
 
-    // Pack position and step variables into a single 32-bit integer,
-    // with x in the top 16 bits and y in the bottom 16 bits.  For
-    // each 16-bit part, the top 6 bits are the integer part and the
-    // bottom 10 bits are the fractional part of the pixel position.
-
-/*
-    position = ((ds_xfrac << 10) & 0xffff0000)
-             | ((ds_yfrac >> 6)  & 0x0000ffff);
-    step = ((ds_xstep << 10) & 0xffff0000)
-         | ((ds_ystep >> 6)  & 0x0000ffff);
-*/
+    *step = crispy->fliplevels ? -1 : 1;
 
-//  dest = ylookup[ds_y] + columnofs[ds_x1];
+    return ylookup[ds_y] + columnofs[flipviewwidth[x]];
+}
 
-    // We do not check for zero spans here?
-    count = ds_x2 - ds_x1;
 
-    do
-    {
-	byte source;
-	// Calculate current texture index in u,v.
-        // [crispy] fix flats getting more distorted the closer they are to the right
-        ytemp = (ds_yfrac >> 10) & 0x0fc0;
-        xtemp = (ds_xfrac >> 16) & 0x3f;
-        spot = xtemp | ytemp;
-
-	// Lookup pixel from flat texture tile,
-	//  re-index using light/colormap.
-	source = ds_source[spot];
-	dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
-	*dest = ds_colormap[ds_brightmap[source]][source];
-
-//      position += step;
-        ds_xfrac += ds_xstep;
-        ds_yfrac += ds_ystep;
+//
+// Draws the actual span.
+void R_DrawSpan (void) 
+{ 
+    pixel_t *dest;
+    int step;
 
-    } while (count--);
+    dest = R_SpanDest(&step, 0);
+    R_DrawSpanPixels(dest, step, ds_x2 - ds_x1 + 1, ds_xfrac, ds_yfrac, 0);
 }
 
 
@@ -937,62 +958,109 @@ void R_DrawSpan (void)
 //
 void R_DrawSpanLow (void)
 {
-//  unsigned int position, step;
-    unsigned int xtemp, ytemp;
     pixel_t *dest;
-    int count;
-    int spot;
+    int step;
 
-#ifdef RANGECHECK
-    if (ds_x2 < ds_x1
-	|| ds_x1<0
-	|| ds_x2>=SCREENWIDTH
-	|| (unsigned)ds_y>SCREENHEIGHT)
+    // Lowres/blocky mode does every pixel twice.
+    dest = R_SpanDest(&step, 1);
+    R_DrawSpanPixels(dest, step, ds_x2 - ds_x1 + 1, ds_xfrac, ds_yfrac, 1);
+}
+
+//
+// [crispy] AVX2 span drawers.
+// These compute the flat texel offsets of 8 pixels at once. The texel,
+// brightmap and colormap lookups stay scalar, since gathering them with
+// AVX2 turned out about twice as slow. The output is identical to
+// R_DrawSpan(), which remains the reference implementation.
+//
+
+#ifdef HAVE_AVX2_DRAWERS
+__attribute__((target("avx2")))
+static inline void R_DrawSpanAVX2Kernel (const int low)
+{
+    const __m256i xmask = _mm256_set1_epi32(0x3f);
+    const __m256i ymask = _mm256_set1_epi32(0x0fc0);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i xstep8 = _mm256_set1_epi32(8 * (unsigned int) ds_xstep);
+    const __m256i ystep8 = _mm256_set1_epi32(8 * (unsigned int) ds_ystep);
+    unsigned int xfrac = ds_xfrac, yfrac = ds_yfrac;
+    __m256i xfracs, yfracs;
+    int spots[8];
+    pixel_t *dest;
+    int count, step, i;
+
+    dest = R_SpanDest(&step, low);
+    count = ds_x2 - ds_x1 + 1;
+
+    xfracs = _mm256_add_epi32(_mm256_set1_epi32(xfrac),
+             _mm256_mullo_epi32(lanes, _mm256_set1_epi32(ds_xstep)));
+    yfracs = _mm256_add_epi32(_mm256_set1_epi32(yfrac),
+             _mm256_mullo_epi32(lanes, _mm256_set1_epi32(ds_ystep)));
+
+    for ( ; count >= 8; count -= 8)
     {
-	I_Error( "R_DrawSpan: %i to %i at %i",
-		 ds_x1,ds_x2,ds_y);
+	const __m256i x = _mm256_and_si256(_mm256_srli_epi32(xfracs, 16), xmask);
+	const __m256i y = _mm256_and_si256(_mm256_srli_epi32(yfracs, 10), ymask);
+
+	_mm256_storeu_si256((__m256i *) spots, _mm256_or_si256(x, y));
+
+	for (i = 0; i < 8; i++)
+	{
+	    dest = R_DrawSpanPixel(dest, step, spots[i], low);
+	}
+
+	xfracs = _mm256_add_epi32(xfracs, xstep8);
+	yfracs = _mm256_add_epi32(yfracs, ystep8);
+	xfrac += 8 * ds_xstep;
+	yfrac += 8 * ds_ystep;
     }
-//	dscount++; 
-#endif
 
-/*
-    position = ((ds_xfrac << 10) & 0xffff0000)
-             | ((ds_yfrac >> 6)  & 0x0000ffff);
-    step = ((ds_xstep << 10) & 0xffff0000)
-         | ((ds_ystep >> 6)  & 0x0000ffff);
-*/
+    R_DrawSpanPixels(dest, step, count, xfrac, yfrac, low);
+}
 
-    count = (ds_x2 - ds_x1);
+__attribute__((target("avx2")))
+static void R_DrawSpanAVX2 (void)
+{
+    R_DrawSpanAVX2Kernel(0);
+}
 
-    // Blocky mode, need to multiply by 2.
-    ds_x1 <<= 1;
-    ds_x2 <<= 1;
+__attribute__((target("avx2")))
+static void R_DrawSpanLowAVX2 (void)
+{
+    R_DrawSpanAVX2Kernel(1);
+}
+#endif
 
-//  dest = ylookup[ds_y] + columnofs[ds_x1];
+// [crispy] span drawers selected by R_InitDrawFuncs()
+drawfuncs_t drawfuncs = {R_DrawSpan, R_DrawSpanLow};
 
-    do
+//
+// R_InitDrawFuncs
+// [crispy] Pick the fastest span drawers this CPU supports.
+//
+void R_InitDrawFuncs (void)
+{
+    //!
+    // @category video
+    //
+    // Only use the plain C span drawers, e.g. to compare their
+    // output or speed with the SIMD ones.
+    //
+
+    if (M_ParmExists("-nosimd"))
     {
-	byte source;
-	// Calculate current texture index in u,v.
-        // [crispy] fix flats getting more distorted the closer they are to the right
-        ytemp = (ds_yfrac >> 10) & 0x0fc0;
-        xtemp = (ds_xfrac >> 16) & 0x3f;
-        spot = xtemp | ytemp;
-
-	// Lowres/blocky mode does it twice,
-	//  while scale is adjusted appropriately.
-	source = ds_source[spot];
-	dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
-	*dest = ds_colormap[ds_brightmap[source]][source];
-	dest = ylookup[ds_y] + columnofs[flipviewwidth[ds_x1++]];
-	*dest = ds_colormap[ds_brightmap[source]][source];
-
-//	position += step;
-	ds_xfrac += ds_xstep;
-	ds_yfrac += ds_ystep;
+	return;
+    }
 
+#ifdef HAVE_AVX2_DRAWERS
+    __builtin_cpu_init();
 
-    } while (count--);
+    if (__builtin_cpu_supports("avx2"))
+    {
+	drawfuncs.span = R_DrawSpanAVX2;
+	drawfuncs.spanlow = R_DrawSpanLowAVX2;
+    }
+#endif
 }
 
 //
@@ -23,17 +23,18 @@
 
 
 
-extern lighttable_t*	dc_colormap[2];
-extern int		dc_x;
-extern int		dc_yl;
-extern int		dc_yh;
-extern fixed_t		dc_iscale;
-extern fixed_t		dc_texturemid;
-extern int		dc_texheight;
-extern byte*		dc_brightmap;
+// [crispy] each render thread draws its own columns
+extern THREADLOCAL lighttable_t*	dc_colormap[2];
+extern THREADLOCAL int		dc_x;
+extern THREADLOCAL int		dc_yl;
+extern THREADLOCAL int		dc_yh;
+extern THREADLOCAL fixed_t	dc_iscale;
+extern THREADLOCAL fixed_t	dc_texturemid;
+extern THREADLOCAL int		dc_texheight;
+extern THREADLOCAL byte*	dc_brightmap;
 
 // first pixel in a column
-extern byte*		dc_source;		
+extern THREADLOCAL byte*	dc_source;		
 
 
 // The span blitting interface.
@@ -64,20 +65,21 @@ R_VideoErase
 ( unsigned	ofs,
   int		count );
 
-extern int		ds_y;
-extern int		ds_x1;
-extern int		ds_x2;
+// [crispy] each render thread draws its own spans
+extern THREADLOCAL int		ds_y;
+extern THREADLOCAL int		ds_x1;
+extern THREADLOCAL int		ds_x2;
 
-extern lighttable_t*	ds_colormap[2];
-extern byte*		ds_brightmap;
+extern THREADLOCAL lighttable_t*	ds_colormap[2];
+extern THREADLOCAL byte*		ds_brightmap;
 
-extern fixed_t		ds_xfrac;
-extern fixed_t		ds_yfrac;
-extern fixed_t		ds_xstep;
-extern fixed_t		ds_ystep;
+extern THREADLOCAL fixed_t		ds_xfrac;
+extern THREADLOCAL fixed_t		ds_yfrac;
+extern THREADLOCAL fixed_t		ds_xstep;
+extern THREADLOCAL fixed_t		ds_ystep;
 
 // start of a 64*64 tile image
-extern byte*		ds_source;		
+extern THREADLOCAL byte*		ds_source;		
 
 extern byte*		translationtables;
 extern byte*		dc_translation;
@@ -90,6 +92,17 @@ void 	R_DrawSpan (void);
 // Low resolution mode, 160x200?
 void 	R_DrawSpanLow (void);
 
+// [crispy] span drawers picked at startup, see R_InitDrawFuncs()
+typedef struct
+{
+    void (*span) (void);
+    void (*spanlow) (void);
+} drawfuncs_t;
+
+extern drawfuncs_t drawfuncs;
+
+void	R_InitDrawFuncs (void);
+
 
 void
 R_InitBuffer
@@ -34,9 +34,11 @@
 #include "m_menu.h"
 
 #include "i_system.h" // [crispy] I_Realloc()
+#include "i_timer.h" // [crispy] I_GetTimeUS()
 #include "p_local.h" // [crispy] MLOOKUNIT
 #include "r_local.h"
 #include "r_sky.h"
+#include "r_stats.h" // [crispy] render statistics
 #include "st_stuff.h" // [crispy] ST_refreshBackground()
 
 
@@ -737,7 +739,7 @@ void R_InitLightTables (void)
 	LIGHTZSHIFT = 20;
     }
 
-    scalelight = malloc(LIGHTLEVELS * sizeof(*scalelight));
+    scalelight = calloc(LIGHTLEVELS, sizeof(*scalelight));
     scalelightfixed = malloc(MAXLIGHTSCALE * sizeof(*scalelightfixed));
     zlight = malloc(LIGHTLEVELS * sizeof(*zlight));
 
@@ -845,7 +847,7 @@ void R_ExecuteSetViewSize (void)
 	fuzzcolfunc = R_DrawFuzzColumn;
 	transcolfunc = R_DrawTranslatedColumn;
 	tlcolfunc = R_DrawTLColumn;
-	spanfunc = R_DrawSpan;
+	spanfunc = drawfuncs.span; // [crispy] SIMD span drawers
     }
     else
     {
@@ -853,7 +855,7 @@ void R_ExecuteSetViewSize (void)
 	fuzzcolfunc = R_DrawFuzzColumnLow;
 	transcolfunc = R_DrawTranslatedColumnLow;
 	tlcolfunc = R_DrawTLColumnLow;
-	spanfunc = R_DrawSpanLow;
+	spanfunc = drawfuncs.spanlow; // [crispy] SIMD span drawers
     }
 
     R_InitBuffer (scaledviewwidth, viewheight);
@@ -893,7 +895,11 @@ void R_ExecuteSetViewSize (void)
     //  for each level / scale combination.
     for (i=0 ; i< LIGHTLEVELS ; i++)
     {
-	scalelight[i] = malloc(MAXLIGHTSCALE * sizeof(**scalelight));
+	// [crispy] only allocate once, the view size may change every frame
+	if (scalelight[i] == NULL)
+	{
+	    scalelight[i] = malloc(MAXLIGHTSCALE * sizeof(**scalelight));
+	}
 
 	startmap = ((LIGHTLEVELS-LIGHTBRIGHT-i)*2)*NUMCOLORMAPS/LIGHTLEVELS;
 	for (j=0 ; j<MAXLIGHTSCALE ; j++)
@@ -932,6 +938,7 @@ void R_ExecuteSetViewSize (void)
 
 void R_Init (void)
 {
+    R_InitDrawFuncs (); // [crispy] SIMD span drawers
     R_InitData ();
     printf (".");
     R_InitPointToAngle ();
@@ -1067,6 +1074,57 @@ void R_SetupFrame (player_t* player)
 
 
 
+//
+// [crispy] R_UpdateFrameBudget
+// Drop the view to low detail while the 3D view takes longer to render
+// than crispy->framebudget milliseconds, and go back to high detail
+// once it fits again. The render time is a moving average, and every
+// switch is followed by a hold-off so it can settle at the new level.
+//
+#define FRAMEBUDGETHOLD 35
+
+static void R_UpdateFrameBudget (uint64_t frametime)
+{
+    static uint64_t avgtime;
+    static int holdframes;
+    const uint64_t budget = (uint64_t) crispy->framebudget * 1000;
+
+    // respect the detail level chosen in the menu
+    if (!crispy->framebudget || detailLevel)
+    {
+	if (setdetail != detailLevel)
+	{
+	    R_SetViewSize (setblocks, detailLevel);
+	}
+	avgtime = 0;
+	holdframes = 0;
+	return;
+    }
+
+    if (setsizeneeded)
+    {
+	return;
+    }
+
+    avgtime = avgtime ? avgtime - avgtime / 8 + frametime / 8 : frametime;
+
+    if (holdframes > 0)
+    {
+	holdframes--;
+	return;
+    }
+
+    // low detail halves the column and span work, so only return to
+    // high detail once the average is well within the budget
+    if ((!setdetail && avgtime > budget) ||
+        (setdetail && avgtime < budget / 2))
+    {
+	R_SetViewSize (setblocks, !setdetail);
+	avgtime = 0;
+	holdframes = FRAMEBUDGETHOLD;
+    }
+}
+
 //
 // R_RenderView
 //
@@ -1074,6 +1132,7 @@ void R_RenderPlayerView (player_t* player)
 {	
     extern void V_DrawFilledBox (int x, int y, int w, int h, int c);
     extern void R_InterpolateTextureOffsets (void);
+    const uint64_t starttime = crispy->framebudget ? I_GetTimeUS() : 0;
 
     R_SetupFrame (player);
 
@@ -1082,6 +1141,7 @@ void R_RenderPlayerView (player_t* player)
     R_ClearDrawSegs ();
     R_ClearPlanes ();
     R_ClearSprites ();
+    R_ClearWallColumns (); // [crispy] deferred wall columns
     if (automapactive && !crispy->automapoverlay)
     {
         R_RenderBSPNode (numnodes-1);
@@ -1103,20 +1163,31 @@ void R_RenderPlayerView (player_t* player)
     // [crispy] smooth texture scrolling
     R_InterpolateTextureOffsets();
     // The head node is the last node output.
+    R_StartRenderPhase (); // [crispy] render statistics
     R_RenderBSPNode (numnodes-1);
+    R_EndRenderPhase (RSTAT_BSP);
     
     // Check for new console commands.
     NetUpdate ();
     
+    R_StartRenderPhase ();
+    R_DrawWallColumns (); // [crispy] deferred wall columns
+    R_EndRenderPhase (RSTAT_WALLS);
     R_DrawPlanes ();
+    R_EndRenderPhase (RSTAT_PLANES);
     
     // Check for new console commands.
     NetUpdate ();
     
     // [crispy] draw fuzz effect independent of rendering frame rate
     R_SetFuzzPosDraw();
+    R_StartRenderPhase ();
     R_DrawMasked ();
+    R_EndRenderPhase (RSTAT_MASKED);
 
     // Check for new console commands.
     NetUpdate ();				
+
+    // [crispy] dynamic detail level
+    R_UpdateFrameBudget (crispy->framebudget ? I_GetTimeUS() - starttime : 0);
 }
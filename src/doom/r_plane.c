@@ -23,6 +23,7 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "i_thread.h" // [crispy] I_RunThreads()
 #include "z_zone.h"
 #include "w_wad.h"
 
@@ -51,6 +52,18 @@ visplane_t*		floorplane;
 visplane_t*		ceilingplane;
 static int		numvisplanes;
 
+// [crispy] hash visplanes by height, picnum and lightlevel
+// Chains hold indices into visplanes[], since that array may be
+// reallocated by R_RaiseVisplanes(). Only the first visplane created
+// for a given key is ever linked in, so lookups return the same plane
+// the linear scan in Vanilla would have found.
+#define VISPLANEHASHSIZE	512
+#define visplane_hash(height, picnum, lightlevel) \
+	(((unsigned int)(picnum) * 3 + (unsigned int)(lightlevel) + \
+	  (unsigned int)(height) * 7) & (VISPLANEHASHSIZE - 1))
+static int		visplanehash[VISPLANEHASHSIZE];
+int			visplaneprobes; // [crispy] hash probes in the current frame
+
 // ?
 #define MAXOPENINGS	MAXWIDTH*64*4
 int			openings[MAXOPENINGS]; // [crispy] 32-bit integer math
@@ -68,15 +81,16 @@ int			ceilingclip[MAXWIDTH]; // [crispy] 32-bit integer math
 //
 // spanstart holds the start of a plane span
 // initialized to 0 at start
+// [crispy] per render thread
 //
-int			spanstart[MAXHEIGHT];
+THREADLOCAL int		spanstart[MAXHEIGHT];
 int			spanstop[MAXHEIGHT];
 
 //
 // texture mapping
 //
-lighttable_t**		planezlight;
-fixed_t			planeheight;
+THREADLOCAL lighttable_t**	planezlight; // [crispy] per render thread
+THREADLOCAL fixed_t		planeheight; // [crispy] per render thread
 
 fixed_t*			yslope;
 fixed_t			yslopes[LOOKDIRS][MAXHEIGHT];
@@ -84,10 +98,27 @@ fixed_t			distscale[MAXWIDTH];
 fixed_t			basexscale;
 fixed_t			baseyscale;
 
-fixed_t			cachedheight[MAXHEIGHT];
-fixed_t			cacheddistance[MAXHEIGHT];
-fixed_t			cachedxstep[MAXHEIGHT];
-fixed_t			cachedystep[MAXHEIGHT];
+// [crispy] per render thread
+THREADLOCAL fixed_t	cachedheight[MAXHEIGHT];
+THREADLOCAL fixed_t	cacheddistance[MAXHEIGHT];
+THREADLOCAL fixed_t	cachedxstep[MAXHEIGHT];
+THREADLOCAL fixed_t	cachedystep[MAXHEIGHT];
+
+// [crispy] regular flats are drawn by all render threads at once,
+// each one restricted to its own strip of screen columns
+typedef struct
+{
+    visplane_t		*pl;
+    int			lumpnum;
+    byte		*source;
+    byte		*brightmap;
+    fixed_t		height;
+    lighttable_t	**zlight;
+} planejob_t;
+
+static planejob_t	*planejobs;
+static int		numplanejobs;
+static int		maxplanejobs;
 
 
 
@@ -97,7 +128,8 @@ fixed_t			cachedystep[MAXHEIGHT];
 //
 void R_InitPlanes (void)
 {
-  // Doh!
+  // [crispy] start the render threads
+  I_InitThreads(crispy->renderthreads);
 }
 
 
@@ -204,6 +236,10 @@ void R_ClearPlanes (void)
 
     lastvisplane = visplanes;
     lastopening = openings;
+
+    // [crispy] empty the visplane hash chains
+    memset (visplanehash, 0xff, sizeof(visplanehash));
+    visplaneprobes = 0;
     
     // texture calculation
     memset (cachedheight, 0, sizeof(cachedheight));
@@ -253,6 +289,8 @@ R_FindPlane
   int		lightlevel )
 {
     visplane_t*	check;
+    unsigned int	hash;
+    int		i;
 	
     // [crispy] add support for MBF sky tranfers
     if (picnum == skyflatnum || picnum & PL_SKYFLAT)
@@ -261,26 +299,33 @@ R_FindPlane
 	lightlevel = 0;
     }
 	
-    for (check=visplanes; check<lastvisplane; check++)
+    // [crispy] walk the hash chain instead of all visplanes
+    hash = visplane_hash(height, picnum, lightlevel);
+
+    for (i = visplanehash[hash]; i != -1; i = check->next)
     {
+	check = visplanes + i;
+	visplaneprobes++;
+
 	if (height == check->height
 	    && picnum == check->picnum
 	    && lightlevel == check->lightlevel)
 	{
-	    break;
+	    return check;
 	}
     }
-    
-			
-    if (check < lastvisplane)
-	return check;
 		
+    check = lastvisplane;
     R_RaiseVisplanes(&check); // [crispy] remove VISPLANES limit
     if (lastvisplane - visplanes == MAXVISPLANES && false)
 	I_Error ("R_FindPlane: no more visplanes");
 		
     lastvisplane++;
 
+    // [crispy] link the new visplane into its hash chain
+    check->next = visplanehash[hash];
+    visplanehash[hash] = check - visplanes;
+
     check->height = height;
     check->picnum = picnum;
     check->lightlevel = lightlevel;
@@ -403,6 +448,59 @@ R_MakeSpans
 
 
 
+//
+// [crispy] R_DrawPlaneColumns
+// Draws the columns x1 to x2 of a visplane. Spans are closed at the
+// strip edges, which leaves the drawn pixels unchanged since every
+// span recomputes its texture coordinates from its first column.
+//
+static void R_DrawPlaneColumns (visplane_t *pl, int x1, int x2)
+{
+    int			x;
+
+    R_MakeSpans(x1, 0xffffffffu, 0, pl->top[x1], pl->bottom[x1]);
+
+    for (x = x1 + 1; x <= x2; x++)
+    {
+	R_MakeSpans(x,pl->top[x-1],
+		    pl->bottom[x-1],
+		    pl->top[x],
+		    pl->bottom[x]);
+    }
+
+    R_MakeSpans(x2 + 1, pl->top[x2], pl->bottom[x2], 0xffffffffu, 0);
+}
+
+//
+// [crispy] R_DrawPlanesThread
+// Draws all queued regular flats within one strip of the view.
+//
+static void R_DrawPlanesThread (int index, int count, void *data)
+{
+    const int		stripx1 = viewwidth * index / count;
+    const int		stripx2 = viewwidth * (index + 1) / count - 1;
+    planejob_t*		job;
+
+    // texture calculation
+    memset (cachedheight, 0, sizeof(cachedheight));
+
+    for (job = planejobs; job < planejobs + numplanejobs; job++)
+    {
+	const int x1 = MAX(job->pl->minx, stripx1);
+	const int x2 = MIN(job->pl->maxx, stripx2);
+
+	if (x1 > x2)
+	    continue;
+
+	ds_source = job->source;
+	ds_brightmap = job->brightmap;
+	planeheight = job->height;
+	planezlight = job->zlight;
+
+	R_DrawPlaneColumns(job->pl, x1, x2);
+    }
+}
+
 //
 // R_DrawPlanes
 // At the end of each frame.
@@ -410,9 +508,9 @@ R_MakeSpans
 void R_DrawPlanes (void)
 {
     visplane_t*		pl;
+    planejob_t*		job;
     int			light;
     int			x;
-    int			stop;
     int			angle;
     int                 lumpnum;
 				
@@ -430,6 +528,8 @@ void R_DrawPlanes (void)
 		 lastopening - openings);
 #endif
 
+    numplanejobs = 0;
+
     for (pl = visplanes ; pl < lastvisplane ; pl++)
     {
 	const boolean swirling = (flattranslation[pl->picnum] == -1);
@@ -495,11 +595,6 @@ void R_DrawPlanes (void)
 	
 	// regular flat
         lumpnum = firstflat + (swirling ? pl->picnum : flattranslation[pl->picnum]);
-	// [crispy] add support for SMMU swirling flats
-	ds_source = swirling ? R_DistortedFlat(lumpnum) : W_CacheLumpNum(lumpnum, PU_STATIC);
-	ds_brightmap = R_BrightmapForFlatNum(lumpnum-firstflat);
-	
-	planeheight = abs(pl->height-viewz);
 	light = (pl->lightlevel >> LIGHTSEGSHIFT)+(extralight * LIGHTBRIGHT);
 
 	if (light >= LIGHTLEVELS)
@@ -508,21 +603,30 @@ void R_DrawPlanes (void)
 	if (light < 0)
 	    light = 0;
 
-	planezlight = zlight[light];
-
-	pl->top[pl->maxx+1] = 0xffffffffu; // [crispy] hires / 32-bit integer math
-	pl->top[pl->minx-1] = 0xffffffffu; // [crispy] hires / 32-bit integer math
-		
-	stop = pl->maxx + 1;
-
-	for (x=pl->minx ; x<= stop ; x++)
+	// [crispy] queue the flat for the render threads
+	if (numplanejobs == maxplanejobs)
 	{
-	    R_MakeSpans(x,pl->top[x-1],
-			pl->bottom[x-1],
-			pl->top[x],
-			pl->bottom[x]);
+	    maxplanejobs = maxplanejobs ? 2 * maxplanejobs : MAXVISPLANES;
+	    planejobs = I_Realloc(planejobs, maxplanejobs * sizeof(*planejobs));
 	}
-	
-        W_ReleaseLumpNum(lumpnum);
+
+	job = &planejobs[numplanejobs++];
+	job->pl = pl;
+	// [crispy] add support for SMMU swirling flats
+	// Distorted flats stay valid for the whole tic, see R_DistortedFlat().
+	job->lumpnum = swirling ? -1 : lumpnum;
+	job->source = swirling ? (byte *) R_DistortedFlat(lumpnum) : W_CacheLumpNum(lumpnum, PU_STATIC);
+	job->brightmap = R_BrightmapForFlatNum(lumpnum-firstflat);
+	job->height = abs(pl->height-viewz);
+	job->zlight = zlight[light];
+    }
+
+    // [crispy] draw the queued flats, each thread its own strip
+    I_RunThreads(R_DrawPlanesThread, NULL);
+
+    for (job = planejobs; job < planejobs + numplanejobs; job++)
+    {
+	if (job->lumpnum >= 0)
+	    W_ReleaseLumpNum(job->lumpnum);
     }
 }
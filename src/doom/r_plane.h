@@ -28,6 +28,10 @@
 
 // Visplane related.
 extern  int*		lastopening; // [crispy] 32-bit integer math
+extern  int		visplaneprobes; // [crispy] visplane hash probes per frame
+extern  int		openings[]; // [crispy] render statistics
+extern  visplane_t*	visplanes;
+extern  visplane_t*	lastvisplane;
 
 
 typedef void (*planefunction_t) (int top, int bottom);
@@ -25,6 +25,7 @@
 #include <stdlib.h>
 
 #include "i_system.h"
+#include "i_thread.h" // [crispy] I_RunThreads()
 
 #include "doomdef.h"
 #include "doomstat.h"
@@ -310,6 +311,121 @@ R_RenderMaskedSegRange
 
 
 
+//
+// [crispy] Deferred wall columns.
+// R_RenderSegLoop() only records the columns it would draw. They are
+// drawn in a separate pass by R_DrawWallColumns() once the BSP has been
+// traversed, by all render threads at once. Wall columns are opaque and
+// never overlap, so the order in which they are drawn does not matter.
+// The composites they read from are locked until then.
+//
+typedef struct
+{
+    int			x;
+    int			yl;
+    int			yh;
+    fixed_t		iscale;
+    fixed_t		texturemid;
+    int			texheight;
+    byte*		source;
+    byte*		brightmap;
+    lighttable_t*	colormap[2];
+} colcmd_t;
+
+static colcmd_t*	wallcmds;
+static int		numwallcmds;
+static int		maxwallcmds;
+
+int			wallpixels; // [crispy] pixels filled by walls this frame
+
+//
+// R_ClearWallColumns
+// At begining of frame.
+//
+void R_ClearWallColumns (void)
+{
+    numwallcmds = 0;
+    wallpixels = 0;
+}
+
+//
+// R_QueueWallColumn
+// Record the column described by the dc_* variables.
+// dc_source points into the composite of the given texture.
+//
+static void R_QueueWallColumn (int tex)
+{
+    colcmd_t*	cmd;
+
+    if (dc_yh < dc_yl)
+	return;
+
+    R_LockComposite (tex);
+
+    if (numwallcmds == maxwallcmds)
+    {
+	maxwallcmds = maxwallcmds ? 2 * maxwallcmds : MAXWIDTH * 4;
+	wallcmds = I_Realloc(wallcmds, maxwallcmds * sizeof(*wallcmds));
+    }
+
+    cmd = &wallcmds[numwallcmds++];
+    cmd->x = dc_x;
+    cmd->yl = dc_yl;
+    cmd->yh = dc_yh;
+    cmd->iscale = dc_iscale;
+    cmd->texturemid = dc_texturemid;
+    cmd->texheight = dc_texheight;
+    cmd->source = dc_source;
+    cmd->brightmap = dc_brightmap;
+    cmd->colormap[0] = dc_colormap[0];
+    cmd->colormap[1] = dc_colormap[1];
+
+    wallpixels += dc_yh - dc_yl + 1;
+}
+
+//
+// R_DrawWallColumnsThread
+// Draws the recorded columns that fall into one strip of the view.
+//
+static void R_DrawWallColumnsThread (int index, int count, void *data)
+{
+    const int		stripx1 = viewwidth * index / count;
+    const int		stripx2 = viewwidth * (index + 1) / count - 1;
+    const colcmd_t*	cmd;
+
+    for (cmd = wallcmds; cmd < wallcmds + numwallcmds; cmd++)
+    {
+	if (cmd->x < stripx1 || cmd->x > stripx2)
+	    continue;
+
+	dc_x = cmd->x;
+	dc_yl = cmd->yl;
+	dc_yh = cmd->yh;
+	dc_iscale = cmd->iscale;
+	dc_texturemid = cmd->texturemid;
+	dc_texheight = cmd->texheight;
+	dc_source = cmd->source;
+	dc_brightmap = cmd->brightmap;
+	dc_colormap[0] = cmd->colormap[0];
+	dc_colormap[1] = cmd->colormap[1];
+
+	colfunc ();
+    }
+}
+
+//
+// R_DrawWallColumns
+// After the BSP has been traversed.
+//
+void R_DrawWallColumns (void)
+{
+    I_RunThreads(R_DrawWallColumnsThread, NULL);
+
+    numwallcmds = 0;
+    R_UnlockComposites ();
+}
+
+
 //
 // R_RenderSegLoop
 // Draws zero, one, or two textures (and possibly a masked
@@ -410,7 +526,7 @@ void R_RenderSegLoop (void)
 	    dc_source = R_GetColumn(midtexture,texturecolumn,true);
 	    dc_texheight = textureheight[midtexture]>>FRACBITS; // [crispy] Tutti-Frutti fix
 	    dc_brightmap = texturebrightmap[midtexture];
-	    colfunc ();
+	    R_QueueWallColumn (midtexture); // [crispy] deferred wall columns
 	    ceilingclip[rw_x] = viewheight;
 	    floorclip[rw_x] = -1;
 	}
@@ -434,7 +550,7 @@ void R_RenderSegLoop (void)
 		    dc_source = R_GetColumn(toptexture,texturecolumn,true);
 		    dc_texheight = textureheight[toptexture]>>FRACBITS; // [crispy] Tutti-Frutti fix
 		    dc_brightmap = texturebrightmap[toptexture];
-		    colfunc ();
+		    R_QueueWallColumn (toptexture); // [crispy] deferred wall columns
 		    ceilingclip[rw_x] = mid;
 		}
 		else
@@ -466,7 +582,7 @@ void R_RenderSegLoop (void)
 					    texturecolumn,true);
 		    dc_texheight = textureheight[bottomtexture]>>FRACBITS; // [crispy] Tutti-Frutti fix
 		    dc_brightmap = texturebrightmap[bottomtexture];
-		    colfunc ();
+		    R_QueueWallColumn (bottomtexture); // [crispy] deferred wall columns
 		    floorclip[rw_x] = mid;
 		}
 		else
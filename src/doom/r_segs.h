@@ -29,5 +29,11 @@ R_RenderMaskedSegRange
   int		x1,
   int		x2 );
 
+// [crispy] deferred wall columns
+extern int wallpixels;
+
+void R_ClearWallColumns (void);
+void R_DrawWallColumns (void);
+
 
 #endif
@@ -0,0 +1,156 @@
+//
+// Copyright(C) 2026 Fabian Greffrath
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	[crispy] Per-frame render timings and limit counters,
+//	written as one CSV row per frame during -timedemo.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "doomstat.h"
+#include "i_system.h"
+#include "i_timer.h"
+#include "m_argv.h"
+
+#include "r_local.h"
+#include "r_stats.h"
+
+boolean renderstats = false;
+
+static FILE *statsfile;
+static char *statsfilename;
+static int statsframes;
+
+static uint64_t phasestart;
+static uint64_t phasetime[NUMRSTATS];
+static boolean phaserecorded;
+
+static void R_CloseRenderStats (void)
+{
+    if (statsfile == NULL)
+    {
+        return;
+    }
+
+    if (statsfile != stdout)
+    {
+        fclose(statsfile);
+    }
+    else
+    {
+        fflush(statsfile);
+    }
+
+    statsfile = NULL;
+    renderstats = false;
+
+    printf("Render statistics written for %d frame(s) to %s\n",
+           statsframes, statsfilename);
+}
+
+void R_InitRenderStats (void)
+{
+    int i;
+
+    //!
+    // @category demo
+    // @arg <filename>
+    //
+    // Write per-frame render timings (in microseconds) and limit
+    // counters to the specified file as CSV while running -timedemo.
+    // Use "-" to write to stdout.
+    //
+
+    i = M_CheckParmWithArgs("-renderstats", 1);
+
+    if (i <= 0)
+    {
+        return;
+    }
+
+    statsfilename = myargv[i + 1];
+
+    if (strcmp(statsfilename, "-") != 0)
+    {
+        statsfile = fopen(statsfilename, "w");
+    }
+    else
+    {
+        statsfile = stdout;
+    }
+
+    if (statsfile == NULL)
+    {
+        I_Error("R_InitRenderStats: Unable to open %s", statsfilename);
+    }
+
+    fprintf(statsfile, "frame,gametic,bsp_us,walls_us,planes_us,masked_us,"
+                       "finish_us,visplanes,visplaneprobes,drawsegs,"
+                       "vissprites,openings,wallpixels\n");
+
+    renderstats = true;
+    I_AtExit(R_CloseRenderStats, true);
+}
+
+void R_StartRenderPhase (void)
+{
+    if (renderstats)
+    {
+        phasestart = I_GetTimeUS();
+    }
+}
+
+// Accumulate the time since the last mark into the given phase,
+// and start timing the next one.
+
+void R_EndRenderPhase (rstatphase_t phase)
+{
+    if (renderstats)
+    {
+        const uint64_t now = I_GetTimeUS();
+
+        phasetime[phase] += now - phasestart;
+        phasestart = now;
+        phaserecorded = true;
+    }
+}
+
+// The counters are still valid here, since they are only reset
+// at the start of the next R_RenderPlayerView().
+
+void R_WriteRenderStats (void)
+{
+    if (!renderstats || !phaserecorded)
+    {
+        return;
+    }
+
+    if (timingdemo)
+    {
+        fprintf(statsfile, "%d,%d,%llu,%llu,%llu,%llu,%llu,%d,%d,%d,%d,%d,%d\n",
+                statsframes++, gametic,
+                (unsigned long long) phasetime[RSTAT_BSP],
+                (unsigned long long) phasetime[RSTAT_WALLS],
+                (unsigned long long) phasetime[RSTAT_PLANES],
+                (unsigned long long) phasetime[RSTAT_MASKED],
+                (unsigned long long) phasetime[RSTAT_FINISH],
+                (int) (lastvisplane - visplanes), visplaneprobes,
+                (int) (ds_p - drawsegs), (int) (vissprite_p - vissprites),
+                (int) (lastopening - openings), wallpixels);
+    }
+
+    memset(phasetime, 0, sizeof(phasetime));
+    phaserecorded = false;
+}
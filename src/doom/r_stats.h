@@ -0,0 +1,40 @@
+//
+// Copyright(C) 2026 Fabian Greffrath
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//	[crispy] Per-frame render timings and limit counters
+//
+
+#ifndef __R_STATS__
+#define __R_STATS__
+
+#include "doomtype.h"
+
+typedef enum
+{
+    RSTAT_BSP,
+    RSTAT_WALLS,
+    RSTAT_PLANES,
+    RSTAT_MASKED,
+    RSTAT_FINISH,
+    NUMRSTATS
+} rstatphase_t;
+
+extern boolean renderstats;
+
+void R_InitRenderStats (void);
+void R_StartRenderPhase (void);
+void R_EndRenderPhase (rstatphase_t phase);
+void R_WriteRenderStats (void);
+
+#endif
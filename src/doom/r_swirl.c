@@ -38,8 +38,8 @@
 #define SEQUENCE 1024
 #define FLATSIZE (64 * 64)
 
-static int *offsets;
-static int *offset;
+// [crispy] 16 bits are plenty for an offset into a 64x64 flat
+static uint16_t *offsets;
 
 #define AMP 2
 #define AMP2 2
@@ -49,6 +49,7 @@ void R_InitDistortedFlats()
 {
 	if (!offsets)
 	{
+		uint16_t *offset;
 		int i;
 
 		offsets = I_Realloc(NULL, SEQUENCE * FLATSIZE * sizeof(*offsets));
@@ -89,36 +90,59 @@ void R_InitDistortedFlats()
 	}
 }
 
+// [crispy] Cache of the distorted flats of the current tic, one entry
+// per swirling flat. Entries are never moved or evicted, so a pointer
+// returned by R_DistortedFlat() stays valid for the whole tic, even if
+// several different liquids are visible at the same time.
+typedef struct
+{
+	int flatnum;
+	int swirltic;
+	char pixels[FLATSIZE];
+} swirlflat_t;
+
+static swirlflat_t **swirlflats;
+static int numswirlflats;
+
 char *R_DistortedFlat(int flatnum)
 {
-	static int swirltic = -1;
-	static int swirlflat = -1;
-	static char distortedflat[FLATSIZE];
+	swirlflat_t *swirl = NULL;
+	int i;
 
-	if (swirltic != leveltime)
+	for (i = 0; i < numswirlflats; i++)
 	{
-		offset = offsets + ((leveltime & (SEQUENCE - 1)) * FLATSIZE);
+		if (swirlflats[i]->flatnum == flatnum)
+		{
+			swirl = swirlflats[i];
+			break;
+		}
+	}
+
+	if (swirl == NULL)
+	{
+		swirlflats = I_Realloc(swirlflats, (numswirlflats + 1) * sizeof(*swirlflats));
+		swirl = swirlflats[numswirlflats++] = I_Realloc(NULL, sizeof(*swirl));
 
-		swirltic = leveltime;
-		swirlflat = -1;
+		swirl->flatnum = flatnum;
+		swirl->swirltic = -1;
 	}
 
-	if (swirlflat != flatnum)
+	if (swirl->swirltic != leveltime)
 	{
-		char *normalflat;
-		int i;
+		const uint16_t *offset = offsets + ((leveltime & (SEQUENCE - 1)) * FLATSIZE);
+		const char *normalflat;
 
 		normalflat = W_CacheLumpNum(flatnum, PU_STATIC);
 
 		for (i = 0; i < FLATSIZE; i++)
 		{
-			distortedflat[i] = normalflat[offset[i]];
+			swirl->pixels[i] = normalflat[offset[i]];
 		}
 
 		W_ReleaseLumpNum(flatnum);
 
-		swirlflat = flatnum;
+		swirl->swirltic = leveltime;
 	}
 
-	return distortedflat;
+	return swirl->pixels;
 }
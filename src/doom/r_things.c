@@ -1131,94 +1131,179 @@ void R_DrawPlayerSprites (void)
 
 //
 // R_SortVisSprites
+// [crispy] Stable LSD radix sort on scale instead of the quadratic
+// selection sort. Each key holds the scale in its upper and the index
+// into vissprites[] in its lower 32 bits, so only small integers are
+// moved around and sprites with equal scale keep their original order,
+// which deliberately overlaid sprites rely on. The result is linked
+// into the vsprsortedhead list just as before.
 //
-#ifdef HAVE_QSORT
-// [crispy] use stdlib's qsort() function for sorting the vissprites[] array
-static inline int cmp_vissprites (const void *a, const void *b)
-{
-    const vissprite_t *vsa = (const vissprite_t *) a;
-    const vissprite_t *vsb = (const vissprite_t *) b;
-
-    const int ret = vsa->scale - vsb->scale;
+vissprite_t	vsprsortedhead;
 
-    return ret ? ret : vsa->next - vsb->next;
-}
+static uint64_t	*vsprkeys;
+static uint64_t	*vsprkeys2;
+static int	numvsprkeys;
 
 void R_SortVisSprites (void)
 {
-    int count;
-    vissprite_t *ds;
+    int			i;
+    int			pass;
+    int			count;
+    unsigned int	digits[4][256];
+    uint64_t*		src;
+    uint64_t*		dst;
+    vissprite_t*	ds;
 
     count = vissprite_p - vissprites;
+	
+    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
 
     if (!count)
 	return;
 
-    // [crispy] maintain a stable sort for deliberately overlaid sprites
-    for (ds = vissprites; ds < vissprite_p; ds++)
+    if (count > numvsprkeys)
+    {
+	numvsprkeys = numvissprites;
+	vsprkeys = I_Realloc(vsprkeys, numvsprkeys * sizeof(*vsprkeys));
+	vsprkeys2 = I_Realloc(vsprkeys2, numvsprkeys * sizeof(*vsprkeys2));
+    }
+
+    memset(digits, 0, sizeof(digits));
+
+    for (i = 0; i < count; i++)
     {
-	ds->next = ds + 1;
+	// flip the sign bit so that negative scales sort first
+	const uint32_t scale = (uint32_t) vissprites[i].scale ^ 0x80000000u;
+
+	vsprkeys[i] = ((uint64_t) scale << 32) | (uint32_t) i;
+
+	digits[0][scale & 0xff]++;
+	digits[1][(scale >> 8) & 0xff]++;
+	digits[2][(scale >> 16) & 0xff]++;
+	digits[3][scale >> 24]++;
     }
 
-    qsort(vissprites, count, sizeof(*vissprites), cmp_vissprites);
+    src = vsprkeys;
+    dst = vsprkeys2;
+
+    for (pass = 0; pass < 4; pass++)
+    {
+	const int shift = 32 + 8 * pass;
+	unsigned int offset = 0;
+
+	// all keys share this digit, nothing to do
+	if (digits[pass][(src[0] >> shift) & 0xff] == count)
+	    continue;
+
+	for (i = 0; i < 256; i++)
+	{
+	    const unsigned int n = digits[pass][i];
+	    digits[pass][i] = offset;
+	    offset += n;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+	    dst[digits[pass][(src[i] >> shift) & 0xff]++] = src[i];
+	}
+
+	{
+	    uint64_t *const tmp = src;
+	    src = dst;
+	    dst = tmp;
+	}
+    }
+
+    // link the vissprites in sorted order
+    for (i = 0; i < count; i++)
+    {
+	ds = &vissprites[(uint32_t) src[i]];
+
+	ds->next = &vsprsortedhead;
+	ds->prev = vsprsortedhead.prev;
+	vsprsortedhead.prev->next = ds;
+	vsprsortedhead.prev = ds;
+    }
 }
-#else
-vissprite_t	vsprsortedhead;
 
 
-void R_SortVisSprites (void)
+
+//
+// [crispy] Drawseg index for sprite clipping.
+// The view is divided into bins of DSBINWIDTH columns. Each bin lists,
+// in ascending order, the drawsegs that overlap it and may clip a
+// sprite, i.e. those with a silhouette or a masked mid texture. A
+// sprite then only looks at the drawsegs in the bins it covers instead
+// of at all of them. The index is built once per frame after the BSP
+// has been traversed.
+//
+#define DSBINSHIFT	5
+#define DSBINWIDTH	(1 << DSBINSHIFT)
+#define MAXDSBINS	((MAXWIDTH + DSBINWIDTH - 1) >> DSBINSHIFT)
+
+// sprites covering more bins than this just walk the full list
+#define MAXSPRITEBINS	4
+
+static int	dsbinstart[MAXDSBINS + 2];
+static int*	dsbinsegs;
+static int	numdsbinsegs;
+static int*	dssegs; // all drawsegs that may clip, ascending
+static int	numdssegs;
+static int	maxdssegs;
+
+static void R_BuildDrawsegIndex (void)
 {
-    int			i;
-    int			count;
-    vissprite_t*	ds;
-    vissprite_t*	best;
-    vissprite_t		unsorted;
-    fixed_t		bestscale;
+    const int	numbins = (viewwidth + DSBINWIDTH - 1) >> DSBINSHIFT;
+    drawseg_t*	ds;
+    int		total;
+    int		b;
 
-    count = vissprite_p - vissprites;
-	
-    unsorted.next = unsorted.prev = &unsorted;
+    memset(dsbinstart, 0, sizeof(dsbinstart));
+    numdssegs = 0;
 
-    if (!count)
-	return;
-		
-    for (ds=vissprites ; ds<vissprite_p ; ds++)
+    if (ds_p - drawsegs > maxdssegs)
     {
-	ds->next = ds+1;
-	ds->prev = ds-1;
+	maxdssegs = numdrawsegs;
+	dssegs = I_Realloc(dssegs, maxdssegs * sizeof(*dssegs));
     }
-    
-    vissprites[0].prev = &unsorted;
-    unsorted.next = &vissprites[0];
-    (vissprite_p-1)->next = &unsorted;
-    unsorted.prev = vissprite_p-1;
-    
-    // pull the vissprites out by scale
 
-    vsprsortedhead.next = vsprsortedhead.prev = &vsprsortedhead;
-    for (i=0 ; i<count ; i++)
+    // count the drawsegs per bin
+    for (ds = drawsegs; ds < ds_p; ds++)
     {
-	bestscale = INT_MAX;
-        best = unsorted.next;
-	for (ds=unsorted.next ; ds!= &unsorted ; ds=ds->next)
-	{
-	    if (ds->scale < bestscale)
-	    {
-		bestscale = ds->scale;
-		best = ds;
-	    }
-	}
-	best->next->prev = best->prev;
-	best->prev->next = best->next;
-	best->next = &vsprsortedhead;
-	best->prev = vsprsortedhead.prev;
-	vsprsortedhead.prev->next = best;
-	vsprsortedhead.prev = best;
+	if (!ds->silhouette && !ds->maskedtexturecol)
+	    continue;
+
+	dssegs[numdssegs++] = ds - drawsegs;
+
+	for (b = ds->x1 >> DSBINSHIFT; b <= ds->x2 >> DSBINSHIFT; b++)
+	    dsbinstart[b + 2]++;
     }
-}
-#endif
 
+    for (b = 2, total = 0; b <= numbins + 1; b++)
+    {
+	total += dsbinstart[b];
+	dsbinstart[b] = total;
+    }
+
+    if (total > numdsbinsegs)
+    {
+	numdsbinsegs = total;
+	dsbinsegs = I_Realloc(dsbinsegs, numdsbinsegs * sizeof(*dsbinsegs));
+    }
+
+    // fill the bins, dsbinstart[b + 1] serves as the write cursor
+    for (total = 0; total < numdssegs; total++)
+    {
+	const int i = dssegs[total];
+
+	ds = &drawsegs[i];
+
+	for (b = ds->x1 >> DSBINSHIFT; b <= ds->x2 >> DSBINSHIFT; b++)
+	    dsbinsegs[dsbinstart[b + 1]++] = i;
+    }
 
+    // now dsbinstart[b] .. dsbinstart[b + 1] - 1 is the range of bin b
+}
 
 //
 // R_DrawSprite
@@ -1234,15 +1319,59 @@ void R_DrawSprite (vissprite_t* spr)
     fixed_t		scale;
     fixed_t		lowscale;
     int			silhouette;
+    int			b1, b2, b;
+    int			numlists, l, i;
+    const int*		list[MAXSPRITEBINS];
+    int			listpos[MAXSPRITEBINS];
 		
     for (x = spr->x1 ; x<=spr->x2 ; x++)
 	clipbot[x] = cliptop[x] = -2;
     
+    // [crispy] only look at the drawsegs in the bins the sprite
+    // covers, see R_BuildDrawsegIndex()
+    b1 = spr->x1 >> DSBINSHIFT;
+    b2 = spr->x2 >> DSBINSHIFT;
+
+    if (b2 - b1 < MAXSPRITEBINS)
+    {
+	for (numlists = 0, b = b1; b <= b2; b++, numlists++)
+	{
+	    list[numlists] = dsbinsegs + dsbinstart[b];
+	    listpos[numlists] = dsbinstart[b + 1] - dsbinstart[b] - 1;
+	}
+    }
+    else
+    {
+	list[0] = dssegs;
+	listpos[0] = numdssegs - 1;
+	numlists = 1;
+    }
+
     // Scan drawsegs from end to start for obscuring segs.
     // The first drawseg that has a greater scale
     //  is the clip seg.
-    for (ds=ds_p-1 ; ds >= drawsegs ; ds--)
+    for (;;)
     {
+	// [crispy] merge the bins, highest drawseg first
+	i = -1;
+
+	for (l = 0; l < numlists; l++)
+	{
+	    if (listpos[l] >= 0 && list[l][listpos[l]] > i)
+		i = list[l][listpos[l]];
+	}
+
+	if (i < 0)
+	    break;
+
+	for (l = 0; l < numlists; l++)
+	{
+	    if (listpos[l] >= 0 && list[l][listpos[l]] == i)
+		listpos[l]--;
+	}
+
+	ds = &drawsegs[i];
+
 	// determine if the drawseg obscures the sprite
 	if (ds->x1 > spr->x2
 	    || ds->x2 < spr->x1
@@ -1348,16 +1477,12 @@ void R_DrawMasked (void)
 
     if (vissprite_p > vissprites)
     {
+	R_BuildDrawsegIndex (); // [crispy] drawseg index for sprite clipping
+
 	// draw all vissprites back to front
-#ifdef HAVE_QSORT
-	for (spr = vissprites;
-	     spr < vissprite_p;
-	     spr++)
-#else
 	for (spr = vsprsortedhead.next ;
 	     spr != &vsprsortedhead ;
 	     spr=spr->next)
-#endif
 	{
 	    
 	    R_DrawSprite (spr);
@@ -90,6 +90,17 @@
 
 #define PACKED_STRUCT(...) PACKEDPREFIX struct __VA_ARGS__ PACKEDATTR
 
+// [crispy] Storage class for variables that every worker thread
+// needs its own copy of, e.g. the renderer's span drawing state.
+
+#if defined(_MSC_VER)
+#define THREADLOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define THREADLOCAL __thread
+#else
+#define THREADLOCAL _Thread_local
+#endif
+
 // C99 integer types; with gcc we just use this.  Other compilers
 // should add conditional statements that define the C99 types.
 
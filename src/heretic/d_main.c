@@ -41,6 +41,7 @@
 #include "m_config.h"
 #include "m_controls.h"
 #include "m_misc.h"
+#include "m_savefile.h" // [crispy] savegame_compression
 #include "p_local.h"
 #include "s_sound.h"
 #include "w_main.h"
@@ -760,6 +761,7 @@ void D_BindVariables(void)
     M_BindIntVariable("snd_channels",           &snd_Channels);
     M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("savegame_compression",   &savegame_compression);
     M_BindIntVariable("show_endoom",            &show_endoom);
     M_BindIntVariable("graphical_startup",      &graphical_startup);
 
@@ -672,6 +672,7 @@ char *SV_Filename(int slot);
 void SV_Open(char *fileName);
 void SV_OpenRead(char *fileName);
 void SV_Close(char *fileName);
+void SV_CloseRead(void);
 void SV_Write(void *buffer, int size);
 void SV_WriteByte(byte val);
 void SV_WriteWord(unsigned short val);
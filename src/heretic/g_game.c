@@ -1616,6 +1616,7 @@ void G_DoLoadGame(void)
 
     if (strncmp(readversion, vcheck, VERSIONSIZE) != 0)
     {                           // Bad version
+        SV_CloseRead();
         return;
     }
     gameskill = SV_ReadByte();
@@ -1644,6 +1645,8 @@ void G_DoLoadGame(void)
     {                           // Missing savegame termination marker
         I_Error("Bad savegame");
     }
+
+    SV_CloseRead();
 }
 
 
@@ -22,10 +22,11 @@
 #include "i_swap.h"
 #include "i_system.h"
 #include "m_misc.h"
+#include "m_savefile.h"
 #include "p_local.h"
 #include "v_video.h"
 
-static FILE *SaveGameFP;
+static savefile_t *SaveGameFP;
 
 int vanilla_savegame_limit = 1;
 
@@ -60,12 +61,17 @@ char *SV_Filename(int slot)
 
 void SV_Open(char *fileName)
 {
-    SaveGameFP = fopen(fileName, "wb");
+    SaveGameFP = M_SaveFileOpenWrite(fileName, SAVESTRINGSIZE);
+
+    if (SaveGameFP == NULL)
+    {
+        I_Error("Could not save game to %s", fileName);
+    }
 }
 
 void SV_OpenRead(char *filename)
 {
-    SaveGameFP = fopen(filename, "rb");
+    SaveGameFP = M_SaveFileOpenRead(filename, SAVESTRINGSIZE);
 
     if (SaveGameFP == NULL)
     {
@@ -85,12 +91,22 @@ void SV_Close(char *fileName)
 
     // Enforce the same savegame size limit as in Vanilla Heretic
 
-    if (vanilla_savegame_limit && ftell(SaveGameFP) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && M_SaveFileTell(SaveGameFP) > SAVEGAMESIZE)
     {
         I_Error("Savegame buffer overrun");
     }
 
-    fclose(SaveGameFP);
+    if (!M_SaveFileClose(SaveGameFP))
+    {
+        fprintf(stderr, "SV_Close: Error while writing %s\n", fileName);
+    }
+}
+
+// [crispy] release the savegame read into memory by SV_OpenRead()
+
+void SV_CloseRead(void)
+{
+    M_SaveFileClose(SaveGameFP);
 }
 
 //==========================================================================
@@ -101,7 +117,7 @@ void SV_Close(char *fileName)
 
 void SV_Write(void *buffer, int size)
 {
-    fwrite(buffer, size, 1, SaveGameFP);
+    M_SaveFileWrite(buffer, size, SaveGameFP);
 }
 
 void SV_WriteByte(byte val)
@@ -136,7 +152,7 @@ void SV_WritePtr(const void *ptr)
 
 void SV_Read(void *buffer, int size)
 {
-    int retval = fread(buffer, 1, size, SaveGameFP);
+    int retval = M_SaveFileRead(buffer, size, SaveGameFP);
     if (retval != size)
     {
         I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
@@ -37,6 +37,7 @@
 #include "m_argv.h"
 #include "m_config.h"
 #include "m_controls.h"
+#include "m_savefile.h" // [crispy] savegame_compression
 #include "net_client.h"
 #include "p_local.h"
 #include "v_video.h"
@@ -163,6 +164,7 @@ void D_BindVariables(void)
     M_BindIntVariable("snd_channels",           &snd_Channels);
     M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("savegame_compression",   &savegame_compression);
 
     M_BindStringVariable("savedir", &SavePathConfig);
 
@@ -504,6 +506,21 @@ void D_DoomMain(void)
 
     CheckRecordFrom();
 
+    //!
+    // @arg <n>
+    // @category obscure
+    //
+    // Run a synthetic ACS script for n seconds through each ACS
+    // interpreter, print the instructions per second and exit.
+    //
+
+    p = M_CheckParmWithArgs("-acsbench", 1);
+    if (p)
+    {
+        P_ACSBenchmark(atoi(myargv[p + 1]));
+        I_Quit();
+    }
+
     //!
     // @arg <x>
     // @category demo
@@ -190,6 +190,7 @@ typedef struct mobj_s
 
 // interaction info
     struct mobj_s *bnext, *bprev;       // links in blocks (if needed)
+    struct mobj_s *tnext, *tprev;       // [crispy] links in type list
     struct subsector_s *subsector;
     fixed_t floorz, ceilingz;   // closest together of contacted secs
     fixed_t floorpic;           // contacted sec floorpic
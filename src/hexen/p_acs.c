@@ -23,6 +23,7 @@
 #include "s_sound.h"
 #include "i_swap.h"
 #include "i_system.h"
+#include "i_timer.h"
 #include "p_local.h"
 
 // MACROS ------------------------------------------------------------------
@@ -49,6 +50,127 @@ typedef PACKED_STRUCT (
     int code;
 }) acsHeader_t;
 
+// [crispy] P-Code numbers, in the order of PCodeCmds[]
+
+typedef enum
+{
+    PCD_NOP,
+    PCD_TERMINATE,
+    PCD_SUSPEND,
+    PCD_PUSHNUMBER,
+    PCD_LSPEC1,
+    PCD_LSPEC2,
+    PCD_LSPEC3,
+    PCD_LSPEC4,
+    PCD_LSPEC5,
+    PCD_LSPEC1DIRECT,
+    PCD_LSPEC2DIRECT,
+    PCD_LSPEC3DIRECT,
+    PCD_LSPEC4DIRECT,
+    PCD_LSPEC5DIRECT,
+    PCD_ADD,
+    PCD_SUBTRACT,
+    PCD_MULTIPLY,
+    PCD_DIVIDE,
+    PCD_MODULUS,
+    PCD_EQ,
+    PCD_NE,
+    PCD_LT,
+    PCD_GT,
+    PCD_LE,
+    PCD_GE,
+    PCD_ASSIGNSCRIPTVAR,
+    PCD_ASSIGNMAPVAR,
+    PCD_ASSIGNWORLDVAR,
+    PCD_PUSHSCRIPTVAR,
+    PCD_PUSHMAPVAR,
+    PCD_PUSHWORLDVAR,
+    PCD_ADDSCRIPTVAR,
+    PCD_ADDMAPVAR,
+    PCD_ADDWORLDVAR,
+    PCD_SUBSCRIPTVAR,
+    PCD_SUBMAPVAR,
+    PCD_SUBWORLDVAR,
+    PCD_MULSCRIPTVAR,
+    PCD_MULMAPVAR,
+    PCD_MULWORLDVAR,
+    PCD_DIVSCRIPTVAR,
+    PCD_DIVMAPVAR,
+    PCD_DIVWORLDVAR,
+    PCD_MODSCRIPTVAR,
+    PCD_MODMAPVAR,
+    PCD_MODWORLDVAR,
+    PCD_INCSCRIPTVAR,
+    PCD_INCMAPVAR,
+    PCD_INCWORLDVAR,
+    PCD_DECSCRIPTVAR,
+    PCD_DECMAPVAR,
+    PCD_DECWORLDVAR,
+    PCD_GOTO,
+    PCD_IFGOTO,
+    PCD_DROP,
+    PCD_DELAY,
+    PCD_DELAYDIRECT,
+    PCD_RANDOM,
+    PCD_RANDOMDIRECT,
+    PCD_THINGCOUNT,
+    PCD_THINGCOUNTDIRECT,
+    PCD_TAGWAIT,
+    PCD_TAGWAITDIRECT,
+    PCD_POLYWAIT,
+    PCD_POLYWAITDIRECT,
+    PCD_CHANGEFLOOR,
+    PCD_CHANGEFLOORDIRECT,
+    PCD_CHANGECEILING,
+    PCD_CHANGECEILINGDIRECT,
+    PCD_RESTART,
+    PCD_ANDLOGICAL,
+    PCD_ORLOGICAL,
+    PCD_ANDBITWISE,
+    PCD_ORBITWISE,
+    PCD_EORBITWISE,
+    PCD_NEGATELOGICAL,
+    PCD_LSHIFT,
+    PCD_RSHIFT,
+    PCD_UNARYMINUS,
+    PCD_IFNOTGOTO,
+    PCD_LINESIDE,
+    PCD_SCRIPTWAIT,
+    PCD_SCRIPTWAITDIRECT,
+    PCD_CLEARLINESPECIAL,
+    PCD_CASEGOTO,
+    PCD_BEGINPRINT,
+    PCD_ENDPRINT,
+    PCD_PRINTSTRING,
+    PCD_PRINTNUMBER,
+    PCD_PRINTCHARACTER,
+    PCD_PLAYERCOUNT,
+    PCD_GAMETYPE,
+    PCD_GAMESKILL,
+    PCD_TIMER,
+    PCD_SECTORSOUND,
+    PCD_AMBIENTSOUND,
+    PCD_SOUNDSEQUENCE,
+    PCD_SETLINETEXTURE,
+    PCD_SETLINEBLOCKING,
+    PCD_SETLINESPECIAL,
+    PCD_THINGSOUND,
+    PCD_ENDPRINTBOLD,
+
+    PCD_LEGACY                  // not decoded, run through PCodeCmds[]
+} pcode_t;
+
+// [crispy] A decoded instruction, with its operands already read and
+// validated and jump targets resolved to instruction indices.
+
+typedef struct
+{
+    pcode_t cmd;
+    int offset;                 // lump offset of the instruction
+    int next;                   // index of the following instruction
+    int args[6];
+} acsop_t;
+
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
 
 // PUBLIC FUNCTION PROTOTYPES ----------------------------------------------
@@ -169,6 +291,7 @@ static int CmdThingSound(void);
 static int CmdEndPrintBold(void);
 
 static void ThingCount(int type, int tid);
+static int DecodeACS(int offset);
 
 // EXTERNAL DATA DECLARATIONS ----------------------------------------------
 
@@ -193,6 +316,14 @@ static char **ACStrings;
 static char PrintBuffer[PRINT_BUFFER_SIZE];
 static acs_t *NewScript;
 
+// [crispy] decoded instructions of the current behavior lump
+static acsop_t *ACSOps;
+static int NumACSOps, MaxACSOps;
+static int *ACSOpAt;            // lump offset -> instruction index + 1
+static int ACSOpIndex = -1;     // instruction being executed, if decoded
+static int *ACSWork;
+static int NumACSWork, MaxACSWork;
+
 static int (*PCodeCmds[]) (void) =
 {
         CmdNOP,
@@ -320,6 +451,14 @@ static void ACSAssert(int condition, const char *fmt, ...)
         return;
     }
 
+    // [crispy] decoded instructions don't keep the context up to date
+    if (ACSOpIndex >= 0)
+    {
+        M_snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x, cmd=%d",
+                   ACSInfo[ACScript->infoIndex].number,
+                   ACSOps[ACSOpIndex].offset + 4, ACSOps[ACSOpIndex].cmd);
+    }
+
     va_start(args, fmt);
     M_vsnprintf(buf, sizeof(buf), fmt, args);
     va_end(args);
@@ -440,20 +579,218 @@ static int ReadOffset(void)
     return offset;
 }
 
+//==========================================================================
+//
+// DecodeOperands
+//
+// [crispy] Reads the operands of an instruction at *offset, advancing it
+// past them. Returns false if ReadCodeInt() and friends would fail, so
+// that the instruction is left to PCodeCmds[] to report the error.
+//
+//==========================================================================
+
+static boolean DecodeOperands(acsop_t *op, int *offset)
+{
+    int i, count, var, limit;
+
+    switch (op->cmd)
+    {
+        case PCD_PUSHNUMBER:
+        case PCD_LSPEC1:
+        case PCD_LSPEC2:
+        case PCD_LSPEC3:
+        case PCD_LSPEC4:
+        case PCD_LSPEC5:
+        case PCD_DELAYDIRECT:
+        case PCD_TAGWAITDIRECT:
+        case PCD_POLYWAITDIRECT:
+        case PCD_SCRIPTWAITDIRECT:
+        case PCD_GOTO:
+        case PCD_IFGOTO:
+        case PCD_IFNOTGOTO:
+            count = 1;
+            break;
+        case PCD_LSPEC1DIRECT:
+        case PCD_LSPEC2DIRECT:
+        case PCD_LSPEC3DIRECT:
+        case PCD_LSPEC4DIRECT:
+        case PCD_LSPEC5DIRECT:
+            count = op->cmd - PCD_LSPEC1DIRECT + 2;
+            break;
+        case PCD_RANDOMDIRECT:
+        case PCD_THINGCOUNTDIRECT:
+        case PCD_CHANGEFLOORDIRECT:
+        case PCD_CHANGECEILINGDIRECT:
+        case PCD_CASEGOTO:
+            count = 2;
+            break;
+        default:
+            count = op->cmd >= PCD_ASSIGNSCRIPTVAR
+                 && op->cmd <= PCD_DECWORLDVAR ? 1 : 0;
+            break;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (*offset + 3 >= ActionCodeSize)
+        {
+            return false;
+        }
+        op->args[i] = LONG(*(int *) (ActionCodeBase + *offset));
+        *offset += 4;
+    }
+
+    // Validate variable numbers and jump targets
+    if (op->cmd >= PCD_ASSIGNSCRIPTVAR && op->cmd <= PCD_DECWORLDVAR)
+    {
+        var = (op->cmd - PCD_ASSIGNSCRIPTVAR) % 3;
+        limit = var == 0 ? MAX_ACS_SCRIPT_VARS :
+                var == 1 ? MAX_ACS_MAP_VARS : MAX_ACS_WORLD_VARS;
+        return op->args[0] >= 0 && op->args[0] < limit;
+    }
+    if (op->cmd == PCD_GOTO || op->cmd == PCD_IFGOTO
+     || op->cmd == PCD_IFNOTGOTO || op->cmd == PCD_CASEGOTO)
+    {
+        var = op->args[count - 1];
+        return var >= 0 && var < ActionCodeSize;
+    }
+
+    return true;
+}
+
+//==========================================================================
+//
+// DecodeACS
+//
+// [crispy] Decodes the code reachable from the given lump offset, unless
+// already done, and returns the index of the instruction there. Code is
+// followed along jumps, so data between scripts is never decoded.
+//
+//==========================================================================
+
+static int DecodeACS(int offset)
+{
+    int first, start, prev, index, i;
+    acsop_t *op;
+
+    first = NumACSOps;
+    start = offset;
+
+    if (MaxACSWork == 0)
+    {
+        MaxACSWork = 64;
+        ACSWork = I_Realloc(NULL, MaxACSWork * sizeof(*ACSWork));
+    }
+    NumACSWork = 0;
+    ACSWork[NumACSWork++] = offset;
+
+    while (NumACSWork > 0)
+    {
+        offset = ACSWork[--NumACSWork];
+        prev = -1;
+
+        for (;;)
+        {
+            if (ACSOpAt[offset])
+            {
+                if (prev >= 0)
+                {
+                    ACSOps[prev].next = ACSOpAt[offset] - 1;
+                }
+                break;
+            }
+
+            if (NumACSOps == MaxACSOps)
+            {
+                MaxACSOps = MaxACSOps ? 2 * MaxACSOps : 1024;
+                ACSOps = I_Realloc(ACSOps, MaxACSOps * sizeof(*ACSOps));
+            }
+            index = NumACSOps++;
+            ACSOpAt[offset] = index + 1;
+            if (prev >= 0)
+            {
+                ACSOps[prev].next = index;
+            }
+
+            op = &ACSOps[index];
+            memset(op, 0, sizeof(*op));
+            op->offset = offset;
+            op->next = -1;
+
+            if (offset + 3 >= ActionCodeSize)
+            {
+                op->cmd = PCD_LEGACY;
+                break;
+            }
+            op->cmd = LONG(*(int *) (ActionCodeBase + offset));
+            offset += 4;
+
+            if (op->cmd < 0 || op->cmd >= arrlen(PCodeCmds)
+             || !DecodeOperands(op, &offset))
+            {
+                op->cmd = PCD_LEGACY;
+                break;
+            }
+
+            if (op->cmd == PCD_GOTO || op->cmd == PCD_IFGOTO
+             || op->cmd == PCD_IFNOTGOTO || op->cmd == PCD_CASEGOTO)
+            {
+                if (NumACSWork == MaxACSWork)
+                {
+                    MaxACSWork *= 2;
+                    ACSWork = I_Realloc(ACSWork, MaxACSWork * sizeof(*ACSWork));
+                }
+                ACSWork[NumACSWork++] = op->args[op->cmd == PCD_CASEGOTO];
+            }
+
+            if (op->cmd == PCD_TERMINATE || op->cmd == PCD_GOTO
+             || op->cmd == PCD_RESTART)
+            {
+                break;
+            }
+
+            prev = index;
+        }
+    }
+
+    // Resolve jump targets to instruction indices
+    for (i = first; i < NumACSOps; i++)
+    {
+        op = &ACSOps[i];
+
+        if (op->cmd == PCD_GOTO || op->cmd == PCD_IFGOTO
+         || op->cmd == PCD_IFNOTGOTO)
+        {
+            op->args[0] = ACSOpAt[op->args[0]] - 1;
+        }
+        else if (op->cmd == PCD_CASEGOTO)
+        {
+            op->args[1] = ACSOpAt[op->args[1]] - 1;
+        }
+    }
+
+    return ACSOpAt[start] - 1;
+}
+
 //==========================================================================
 //
 // P_LoadACScripts
 //
 //==========================================================================
 
-void P_LoadACScripts(int lump)
+static void LoadACScripts(byte *base, int size, int lump)
 {
     int i, offset;
     acsHeader_t *header;
     acsInfo_t *info;
 
-    ActionCodeBase = W_CacheLumpNum(lump, PU_LEVEL);
-    ActionCodeSize = W_LumpLength(lump);
+    ActionCodeBase = base;
+    ActionCodeSize = size;
+
+    // [crispy] forget the instructions decoded from the previous lump
+    NumACSOps = 0;
+    ACSOpAt = I_Realloc(ACSOpAt, (ActionCodeSize + 1) * sizeof(*ACSOpAt));
+    memset(ACSOpAt, 0, (ActionCodeSize + 1) * sizeof(*ACSOpAt));
 
     M_snprintf(EvalContext, sizeof(EvalContext),
                "header parsing of lump #%d", lump);
@@ -511,6 +848,17 @@ void P_LoadACScripts(int lump)
     }
 
     memset(MapVars, 0, sizeof(MapVars));
+
+    // [crispy] decode all scripts up front
+    for (i = 0; i < ACScriptCount; i++)
+    {
+        DecodeACS(ACSInfo[i].offset);
+    }
+}
+
+void P_LoadACScripts(int lump)
+{
+    LoadACScripts(W_CacheLumpNum(lump, PU_LEVEL), W_LumpLength(lump), lump);
 }
 
 //==========================================================================
@@ -764,6 +1112,308 @@ void P_ACSInitNewGame(void)
     memset(ACSStore, 0, sizeof(ACSStore));
 }
 
+//==========================================================================
+//
+// InterpretLegacy
+//
+// [crispy] Runs the instruction at PCodeOffset straight from the lump,
+// through PCodeCmds[]. This is what happens to everything that could not
+// be decoded, and it reports any errors in there.
+//
+//==========================================================================
+
+static int InterpretLegacy(void)
+{
+    int cmd;
+
+    M_snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x",
+               ACSInfo[ACScript->infoIndex].number, PCodeOffset);
+    cmd = ReadCodeInt();
+    M_snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x, cmd=%d",
+               ACSInfo[ACScript->infoIndex].number, PCodeOffset, cmd);
+    ACSAssert(cmd >= 0, "negative ACS instruction %d", cmd);
+    ACSAssert(cmd < arrlen(PCodeCmds),
+              "invalid ACS instruction %d (maybe this WAD is designed "
+              "for an advanced source port and is not vanilla "
+              "compatible)", cmd);
+    return PCodeCmds[cmd]();
+}
+
+//==========================================================================
+//
+// InterpretDecoded
+//
+// [crispy] Runs the script from the decoded instruction at index pc on,
+// until it stops. Leaves the lump offset to continue at in PCodeOffset.
+//
+//==========================================================================
+
+static int InterpretDecoded(int pc)
+{
+    acsop_t *op;
+    int action;
+    int operand2;
+    int sectorIndex;
+    int flat;
+    int i;
+
+    for (;;)
+    {
+        op = &ACSOps[pc];
+        ACSOpIndex = pc;
+        action = SCRIPT_CONTINUE;
+
+        switch (op->cmd)
+        {
+            case PCD_TERMINATE:
+                action = SCRIPT_TERMINATE;
+                break;
+            case PCD_PUSHNUMBER:
+                Push(op->args[0]);
+                break;
+            case PCD_LSPEC1:
+            case PCD_LSPEC2:
+            case PCD_LSPEC3:
+            case PCD_LSPEC4:
+            case PCD_LSPEC5:
+                for (i = op->cmd - PCD_LSPEC1; i >= 0; i--)
+                {
+                    SpecArgs[i] = Pop();
+                }
+                P_ExecuteLineSpecial(op->args[0], SpecArgs, ACScript->line,
+                                     ACScript->side, ACScript->activator);
+                break;
+            case PCD_LSPEC1DIRECT:
+            case PCD_LSPEC2DIRECT:
+            case PCD_LSPEC3DIRECT:
+            case PCD_LSPEC4DIRECT:
+            case PCD_LSPEC5DIRECT:
+                for (i = op->cmd - PCD_LSPEC1DIRECT; i >= 0; i--)
+                {
+                    SpecArgs[i] = op->args[i + 1];
+                }
+                P_ExecuteLineSpecial(op->args[0], SpecArgs, ACScript->line,
+                                     ACScript->side, ACScript->activator);
+                break;
+            case PCD_ADD:
+                Push(Pop() + Pop());
+                break;
+            case PCD_SUBTRACT:
+                operand2 = Pop();
+                Push(Pop() - operand2);
+                break;
+            case PCD_MULTIPLY:
+                Push(Pop() * Pop());
+                break;
+            case PCD_EQ:
+                Push(Pop() == Pop());
+                break;
+            case PCD_NE:
+                Push(Pop() != Pop());
+                break;
+            case PCD_LT:
+                operand2 = Pop();
+                Push(Pop() < operand2);
+                break;
+            case PCD_GT:
+                operand2 = Pop();
+                Push(Pop() > operand2);
+                break;
+            case PCD_LE:
+                operand2 = Pop();
+                Push(Pop() <= operand2);
+                break;
+            case PCD_GE:
+                operand2 = Pop();
+                Push(Pop() >= operand2);
+                break;
+            case PCD_ASSIGNSCRIPTVAR:
+                ACScript->vars[op->args[0]] = Pop();
+                break;
+            case PCD_ASSIGNMAPVAR:
+                MapVars[op->args[0]] = Pop();
+                break;
+            case PCD_ASSIGNWORLDVAR:
+                WorldVars[op->args[0]] = Pop();
+                break;
+            case PCD_PUSHSCRIPTVAR:
+                Push(ACScript->vars[op->args[0]]);
+                break;
+            case PCD_PUSHMAPVAR:
+                Push(MapVars[op->args[0]]);
+                break;
+            case PCD_PUSHWORLDVAR:
+                Push(WorldVars[op->args[0]]);
+                break;
+            case PCD_ADDSCRIPTVAR:
+                ACScript->vars[op->args[0]] += Pop();
+                break;
+            case PCD_ADDMAPVAR:
+                MapVars[op->args[0]] += Pop();
+                break;
+            case PCD_ADDWORLDVAR:
+                WorldVars[op->args[0]] += Pop();
+                break;
+            case PCD_SUBSCRIPTVAR:
+                ACScript->vars[op->args[0]] -= Pop();
+                break;
+            case PCD_SUBMAPVAR:
+                MapVars[op->args[0]] -= Pop();
+                break;
+            case PCD_SUBWORLDVAR:
+                WorldVars[op->args[0]] -= Pop();
+                break;
+            case PCD_MULSCRIPTVAR:
+                ACScript->vars[op->args[0]] *= Pop();
+                break;
+            case PCD_MULMAPVAR:
+                MapVars[op->args[0]] *= Pop();
+                break;
+            case PCD_MULWORLDVAR:
+                WorldVars[op->args[0]] *= Pop();
+                break;
+            case PCD_DIVSCRIPTVAR:
+                ACScript->vars[op->args[0]] /= Pop();
+                break;
+            case PCD_DIVMAPVAR:
+                MapVars[op->args[0]] /= Pop();
+                break;
+            case PCD_DIVWORLDVAR:
+                WorldVars[op->args[0]] /= Pop();
+                break;
+            case PCD_MODSCRIPTVAR:
+                ACScript->vars[op->args[0]] %= Pop();
+                break;
+            case PCD_MODMAPVAR:
+                MapVars[op->args[0]] %= Pop();
+                break;
+            case PCD_MODWORLDVAR:
+                WorldVars[op->args[0]] %= Pop();
+                break;
+            case PCD_INCSCRIPTVAR:
+                ++ACScript->vars[op->args[0]];
+                break;
+            case PCD_INCMAPVAR:
+                ++MapVars[op->args[0]];
+                break;
+            case PCD_INCWORLDVAR:
+                ++WorldVars[op->args[0]];
+                break;
+            case PCD_DECSCRIPTVAR:
+                --ACScript->vars[op->args[0]];
+                break;
+            case PCD_DECMAPVAR:
+                --MapVars[op->args[0]];
+                break;
+            case PCD_DECWORLDVAR:
+                --WorldVars[op->args[0]];
+                break;
+            case PCD_GOTO:
+                pc = op->args[0];
+                continue;
+            case PCD_IFGOTO:
+                if (Pop() != 0)
+                {
+                    pc = op->args[0];
+                    continue;
+                }
+                break;
+            case PCD_IFNOTGOTO:
+                if (Pop() == 0)
+                {
+                    pc = op->args[0];
+                    continue;
+                }
+                break;
+            case PCD_CASEGOTO:
+                if (Top() == op->args[0])
+                {
+                    Drop();
+                    pc = op->args[1];
+                    continue;
+                }
+                break;
+            case PCD_DROP:
+                Drop();
+                break;
+            case PCD_DELAYDIRECT:
+                ACScript->delayCount = op->args[0];
+                action = SCRIPT_STOP;
+                break;
+            case PCD_RANDOMDIRECT:
+                Push(op->args[0]
+                     + (P_Random() % (op->args[1] - op->args[0] + 1)));
+                break;
+            case PCD_THINGCOUNTDIRECT:
+                ThingCount(op->args[0], op->args[1]);
+                break;
+            case PCD_TAGWAITDIRECT:
+                ACSInfo[ACScript->infoIndex].waitValue = op->args[0];
+                ACSInfo[ACScript->infoIndex].state = ASTE_WAITINGFORTAG;
+                action = SCRIPT_STOP;
+                break;
+            case PCD_POLYWAITDIRECT:
+                ACSInfo[ACScript->infoIndex].waitValue = op->args[0];
+                ACSInfo[ACScript->infoIndex].state = ASTE_WAITINGFORPOLY;
+                action = SCRIPT_STOP;
+                break;
+            case PCD_SCRIPTWAITDIRECT:
+                ACSInfo[ACScript->infoIndex].waitValue = op->args[0];
+                ACSInfo[ACScript->infoIndex].state = ASTE_WAITINGFORSCRIPT;
+                action = SCRIPT_STOP;
+                break;
+            case PCD_CHANGEFLOORDIRECT:
+            case PCD_CHANGECEILINGDIRECT:
+                flat = R_FlatNumForName(StringLookup(op->args[1]));
+                sectorIndex = -1;
+                while ((sectorIndex = P_FindSectorFromTag(op->args[0],
+                                                          sectorIndex)) >= 0)
+                {
+                    if (op->cmd == PCD_CHANGEFLOORDIRECT)
+                    {
+                        sectors[sectorIndex].floorpic = flat;
+                    }
+                    else
+                    {
+                        sectors[sectorIndex].ceilingpic = flat;
+                    }
+                }
+                break;
+            case PCD_RESTART:
+                pc = ACSOpAt[ACSInfo[ACScript->infoIndex].offset] - 1;
+                continue;
+            case PCD_LEGACY:
+                ACSOpIndex = -1;
+                PCodeOffset = op->offset;
+                action = InterpretLegacy();
+                if (action != SCRIPT_CONTINUE)
+                {
+                    return action;
+                }
+                pc = ACSOpAt[PCodeOffset] ? ACSOpAt[PCodeOffset] - 1
+                                          : DecodeACS(PCodeOffset);
+                continue;
+            default:
+                // No operands, the command doesn't need to know where
+                // it is in the lump
+                action = PCodeCmds[op->cmd]();
+                break;
+        }
+
+        if (action != SCRIPT_CONTINUE)
+        {
+            ACSOpIndex = -1;
+            if (op->next >= 0)
+            {
+                PCodeOffset = ACSOps[op->next].offset;
+            }
+            return action;
+        }
+
+        pc = op->next;
+    }
+}
+
 //==========================================================================
 //
 // T_InterpretACS
@@ -772,7 +1422,6 @@ void P_ACSInitNewGame(void)
 
 void T_InterpretACS(acs_t * script)
 {
-    int cmd;
     int action;
 
     if (ACSInfo[script->infoIndex].state == ASTE_TERMINATING)
@@ -794,20 +1443,21 @@ void T_InterpretACS(acs_t * script)
     ACScript = script;
     PCodeOffset = ACScript->ip;
 
-    do
+    // [crispy] run the decoded instructions, unless the instruction
+    // pointer (e.g. from a savegame) is outside of the lump
+    if (script->ip >= 0 && script->ip <= ActionCodeSize)
     {
-        M_snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x",
-                   ACSInfo[script->infoIndex].number, PCodeOffset);
-        cmd = ReadCodeInt();
-        M_snprintf(EvalContext, sizeof(EvalContext), "script %d @0x%x, cmd=%d",
-                   ACSInfo[script->infoIndex].number, PCodeOffset, cmd);
-        ACSAssert(cmd >= 0, "negative ACS instruction %d", cmd);
-        ACSAssert(cmd < arrlen(PCodeCmds),
-                  "invalid ACS instruction %d (maybe this WAD is designed "
-                  "for an advanced source port and is not vanilla "
-                  "compatible)", cmd);
-        action = PCodeCmds[cmd]();
-    } while (action == SCRIPT_CONTINUE);
+        action = InterpretDecoded(ACSOpAt[PCodeOffset] ?
+                                  ACSOpAt[PCodeOffset] - 1 :
+                                  DecodeACS(PCodeOffset));
+    }
+    else
+    {
+        do
+        {
+            action = InterpretLegacy();
+        } while (action == SCRIPT_CONTINUE);
+    }
 
     ACScript->ip = PCodeOffset;
 
@@ -1488,7 +2138,6 @@ static void ThingCount(int type, int tid)
     int searcher;
     mobj_t *mobj;
     mobjtype_t moType;
-    thinker_t *think;
 
     if (!(type + tid))
     {                           // Nothing to count
@@ -1517,18 +2166,14 @@ static void ThingCount(int type, int tid)
     }
     else
     {                           // Count only types
-        for (think = thinkercap.next; think != &thinkercap;
-             think = think->next)
+        // [crispy] only visit the mobjs of this type
+        for (mobj = P_FirstMobjOfType(moType); mobj != NULL;
+             mobj = mobj->tnext)
         {
-            if (think->function != P_MobjThinker)
+            if (mobj->thinker.function != P_MobjThinker)
             {                   // Not a mobj thinker
                 continue;
             }
-            mobj = (mobj_t *) think;
-            if (mobj->type != moType)
-            {                   // Doesn't match
-                continue;
-            }
             if (mobj->flags & MF_COUNTKILL && mobj->health <= 0)
             {                   // Don't count dead monsters
                 continue;
@@ -1995,3 +2640,95 @@ static int CmdSetLineSpecial(void)
     }
     return SCRIPT_CONTINUE;
 }
+
+//==========================================================================
+//
+// P_ACSBenchmark
+//
+// [crispy] Runs a synthetic script for the given number of seconds, once
+// through the decoded instructions and once instruction by instruction
+// straight from the lump, and prints the instructions per second of both.
+//
+//==========================================================================
+
+#define BENCH_LOOPS 1000
+
+static const int BenchCode[] =
+{
+    // header
+    'A' | ('C' << 8) | ('S' << 16), 136, 12,
+    // 12: var0 = 0
+    PCD_PUSHNUMBER, 0, PCD_ASSIGNSCRIPTVAR, 0,
+    // 28: while (var0 < BENCH_LOOPS)
+    PCD_PUSHSCRIPTVAR, 0, PCD_PUSHNUMBER, BENCH_LOOPS, PCD_LT,
+    PCD_IFNOTGOTO, 124,
+    // 56: map0 = (map0 + var0 * 3) & 0xffff
+    PCD_PUSHMAPVAR, 0, PCD_PUSHSCRIPTVAR, 0, PCD_PUSHNUMBER, 3,
+    PCD_MULTIPLY, PCD_ADD, PCD_PUSHNUMBER, 0xffff, PCD_ANDBITWISE,
+    PCD_ASSIGNMAPVAR, 0,
+    // 108: var0++
+    PCD_INCSCRIPTVAR, 0, PCD_GOTO, 28,
+    // 124: delay 0, start over
+    PCD_DELAYDIRECT, 0, PCD_RESTART,
+    // 136: one script, no strings
+    1, 1, 12, 0, 0,
+};
+
+// Instructions per run, from the restart to the delay
+#define BENCH_INSTRUCTIONS (1 + 2 + BENCH_LOOPS * 14 + 4 + 1)
+
+void P_ACSBenchmark(int seconds)
+{
+    int *code;
+    acs_t script;
+    uint64_t start, elapsed;
+    int runs;
+    int i;
+
+    if (seconds < 1)
+    {
+        seconds = 1;
+    }
+
+    code = Z_Malloc(sizeof(BenchCode), PU_STATIC, NULL);
+    for (i = 0; i < arrlen(BenchCode); i++)
+    {
+        code[i] = LONG(BenchCode[i]);
+    }
+    LoadACScripts((byte *) code, sizeof(BenchCode), -1);
+
+    memset(&script, 0, sizeof(script));
+    script.number = ACSInfo[0].number;
+    ACSInfo[0].state = ASTE_RUNNING;
+
+    printf("P_ACSBenchmark: %d seconds per interpreter\n", seconds);
+
+    for (i = 0; i < 2; i++)
+    {
+        script.ip = ACSInfo[0].offset;
+        runs = 0;
+        start = I_GetTimeUS();
+
+        do
+        {
+            if (i == 0)
+            {
+                T_InterpretACS(&script);
+            }
+            else
+            {
+                ACScript = &script;
+                PCodeOffset = script.ip;
+                while (InterpretLegacy() == SCRIPT_CONTINUE);
+                script.ip = PCodeOffset;
+            }
+            runs++;
+            elapsed = I_GetTimeUS() - start;
+        } while (elapsed < seconds * 1000000ULL);
+
+        printf("  %s: %.0f instructions/s\n", i == 0 ? "decoded" : "legacy",
+               ((double) runs * BENCH_INSTRUCTIONS - 1) * 1000000.0 / elapsed);
+    }
+
+    Z_Free(code);
+}
@@ -26,7 +26,8 @@
 
 // MACROS ------------------------------------------------------------------
 
-#define MAX_TID_COUNT 200
+// [crispy] hash a TID into one of the TIDHash buckets
+#define TIDHASH(tid) ((unsigned int) (((uint32_t) (tid) * 2654435761u) & TIDHashMask))
 
 // TYPES -------------------------------------------------------------------
 
@@ -73,8 +74,22 @@ fixed_t FloatBobOffsets[64] = {
 
 // PRIVATE DATA DEFINITIONS ------------------------------------------------
 
-static int TIDList[MAX_TID_COUNT + 1];  // +1 for termination marker
-static mobj_t *TIDMobj[MAX_TID_COUNT];
+// [crispy] The TID list grows as needed and keeps the slot order in
+// which P_FindMobjFromTID() has always searched it. Occupied slots are
+// also chained into hash buckets, sorted by slot number, so that
+// searches only visit mobjs with a matching TID.
+static int *TIDList;            // -1 = free slot
+static mobj_t **TIDMobj;
+static int *TIDNext;            // next slot in the same bucket, or -1
+static int TIDCount;            // slots in use, i.e. the termination marker
+static int TIDAlloced;
+static int TIDFirstFree;        // there is no free slot below this one
+static int *TIDHash;            // first slot of each bucket, or -1
+static unsigned int TIDHashMask;
+
+// [crispy] every live mobj is also linked into the list of its type,
+// so that type-only ACS queries need not walk the whole thinker list.
+static mobj_t *MobjTypeList[NUMMOBJTYPES];
 
 // CODE --------------------------------------------------------------------
 
@@ -1248,6 +1263,7 @@ mobj_t *P_SpawnMobj(fixed_t x, fixed_t y, fixed_t z, mobjtype_t type)
 
     mobj->thinker.function = P_MobjThinker;
     P_AddThinker(&mobj->thinker);
+    P_InsertMobjIntoTypeList(mobj);
     return (mobj);
 }
 
@@ -1270,6 +1286,9 @@ void P_RemoveMobj(mobj_t * mobj)
         P_RemoveMobjFromTIDList(mobj);
     }
 
+    // [crispy] Remove from type list
+    P_RemoveMobjFromTypeList(mobj);
+
     // Unlink from sector and block lists
     P_UnsetThingPosition(mobj);
 
@@ -1620,6 +1639,84 @@ void P_SpawnMapThing(mapthing_t * mthing)
     }
 }
 
+//==========================================================================
+//
+// LinkTIDSlot
+//
+// [crispy] Inserts a slot into its hash bucket, keeping it sorted.
+//
+//==========================================================================
+
+static void LinkTIDSlot(int slot)
+{
+    int *prev;
+
+    prev = &TIDHash[TIDHASH(TIDList[slot])];
+    while (*prev != -1 && *prev < slot)
+    {
+        prev = &TIDNext[*prev];
+    }
+    TIDNext[slot] = *prev;
+    *prev = slot;
+}
+
+//==========================================================================
+//
+// UnlinkTIDSlot
+//
+//==========================================================================
+
+static void UnlinkTIDSlot(int slot)
+{
+    int *prev;
+
+    prev = &TIDHash[TIDHASH(TIDList[slot])];
+    while (*prev != slot)
+    {
+        prev = &TIDNext[*prev];
+    }
+    *prev = TIDNext[slot];
+}
+
+//==========================================================================
+//
+// AppendTIDSlot
+//
+// [crispy] Adds a slot at the end of the list, growing it and its hash
+// table as needed.
+//
+//==========================================================================
+
+static int AppendTIDSlot(void)
+{
+    int i;
+
+    if (TIDCount == TIDAlloced)
+    {
+        TIDAlloced = TIDAlloced ? 2 * TIDAlloced : 256;
+        TIDList = I_Realloc(TIDList, TIDAlloced * sizeof(*TIDList));
+        TIDMobj = I_Realloc(TIDMobj, TIDAlloced * sizeof(*TIDMobj));
+        TIDNext = I_Realloc(TIDNext, TIDAlloced * sizeof(*TIDNext));
+
+        // Rehash, one bucket per slot
+        TIDHash = I_Realloc(TIDHash, TIDAlloced * sizeof(*TIDHash));
+        TIDHashMask = TIDAlloced - 1;
+        for (i = 0; i < TIDAlloced; i++)
+        {
+            TIDHash[i] = -1;
+        }
+        for (i = TIDCount - 1; i >= 0; i--)
+        {
+            if (TIDList[i] != -1)
+            {
+                LinkTIDSlot(i);
+            }
+        }
+    }
+
+    return TIDCount++;
+}
+
 //==========================================================================
 //
 // P_CreateTIDList
@@ -1632,7 +1729,13 @@ void P_CreateTIDList(void)
     mobj_t *mobj;
     thinker_t *t;
 
-    i = 0;
+    TIDCount = 0;
+    TIDFirstFree = 0;
+    for (i = 0; i < TIDAlloced; i++)
+    {
+        TIDHash[i] = -1;
+    }
+
     for (t = thinkercap.next; t != &thinkercap; t = t->next)
     {                           // Search all current thinkers
         if (t->function != P_MobjThinker)
@@ -1642,17 +1745,15 @@ void P_CreateTIDList(void)
         mobj = (mobj_t *) t;
         if (mobj->tid != 0)
         {                       // Add to list
-            if (i == MAX_TID_COUNT)
+            i = AppendTIDSlot();
+            TIDList[i] = mobj->tid;
+            TIDMobj[i] = mobj;
+            if (mobj->tid != -1)
             {
-                I_Error("P_CreateTIDList: MAX_TID_COUNT (%d) exceeded.",
-                        MAX_TID_COUNT);
+                LinkTIDSlot(i);
             }
-            TIDList[i] = mobj->tid;
-            TIDMobj[i++] = mobj;
         }
     }
-    // Add termination marker
-    TIDList[i] = 0;
 }
 
 //==========================================================================
@@ -1667,7 +1768,7 @@ void P_InsertMobjIntoTIDList(mobj_t * mobj, int tid)
     int index;
 
     index = -1;
-    for (i = 0; TIDList[i] != 0; i++)
+    for (i = TIDFirstFree; i < TIDCount; i++)
     {
         if (TIDList[i] == -1)
         {                       // Found empty slot
@@ -1677,17 +1778,30 @@ void P_InsertMobjIntoTIDList(mobj_t * mobj, int tid)
     }
     if (index == -1)
     {                           // Append required
-        if (i == MAX_TID_COUNT)
-        {
-            I_Error("P_InsertMobjIntoTIDList: MAX_TID_COUNT (%d)"
-                    "exceeded.", MAX_TID_COUNT);
-        }
-        index = i;
-        TIDList[index + 1] = 0;
+        index = AppendTIDSlot();
     }
+    TIDFirstFree = index + 1;
     mobj->tid = tid;
     TIDList[index] = tid;
     TIDMobj[index] = mobj;
+
+    if (tid == 0)
+    {
+        // [crispy] Vanilla wrote a termination marker into the slot,
+        // which drops it and all slots after it from the list.
+        for (i = index + 1; i < TIDCount; i++)
+        {
+            if (TIDList[i] != -1)
+            {
+                UnlinkTIDSlot(i);
+            }
+        }
+        TIDCount = index;
+    }
+    else if (tid != -1)
+    {
+        LinkTIDSlot(index);
+    }
 }
 
 //==========================================================================
@@ -1700,30 +1814,130 @@ void P_RemoveMobjFromTIDList(mobj_t * mobj)
 {
     int i;
 
-    for (i = 0; TIDList[i] != 0; i++)
+    if (mobj->tid != 0 && mobj->tid != -1 && TIDHash != NULL)
     {
-        if (TIDMobj[i] == mobj)
+        for (i = TIDHash[TIDHASH(mobj->tid)]; i != -1; i = TIDNext[i])
         {
-            TIDList[i] = -1;
-            TIDMobj[i] = NULL;
-            mobj->tid = 0;
-            return;
+            if (TIDMobj[i] == mobj)
+            {
+                UnlinkTIDSlot(i);
+                TIDList[i] = -1;
+                TIDMobj[i] = NULL;
+                if (i < TIDFirstFree)
+                {
+                    TIDFirstFree = i;
+                }
+                break;
+            }
         }
     }
     mobj->tid = 0;
 }
 
+//==========================================================================
+//
+// P_ClearMobjTypeLists
+//
+// [crispy] Forget all mobjs, e.g. when the level's thinkers are freed.
+//
+//==========================================================================
+
+void P_ClearMobjTypeLists(void)
+{
+    memset(MobjTypeList, 0, sizeof(MobjTypeList));
+}
+
+//==========================================================================
+//
+// P_InsertMobjIntoTypeList
+//
+//==========================================================================
+
+void P_InsertMobjIntoTypeList(mobj_t * mobj)
+{
+    mobj_t **head;
+
+    head = &MobjTypeList[mobj->type];
+    mobj->tprev = NULL;
+    mobj->tnext = *head;
+    if (*head != NULL)
+    {
+        (*head)->tprev = mobj;
+    }
+    *head = mobj;
+}
+
+//==========================================================================
+//
+// P_RemoveMobjFromTypeList
+//
+//==========================================================================
+
+void P_RemoveMobjFromTypeList(mobj_t * mobj)
+{
+    if (mobj->tprev != NULL)
+    {
+        mobj->tprev->tnext = mobj->tnext;
+    }
+    else if (MobjTypeList[mobj->type] == mobj)
+    {
+        MobjTypeList[mobj->type] = mobj->tnext;
+    }
+    else
+    {                           // Not linked
+        return;
+    }
+    if (mobj->tnext != NULL)
+    {
+        mobj->tnext->tprev = mobj->tprev;
+    }
+    mobj->tnext = mobj->tprev = NULL;
+}
+
+//==========================================================================
+//
+// P_FirstMobjOfType
+//
+// [crispy] Returns the head of the list of live mobjs of the given type,
+// to be followed through mobj->tnext.
+//
+//==========================================================================
+
+mobj_t *P_FirstMobjOfType(mobjtype_t type)
+{
+    return MobjTypeList[type];
+}
+
 //==========================================================================
 //
 // P_FindMobjFromTID
 //
+// [crispy] Returns the mobj in the next slot after *searchPosition with
+// the given TID, walking only that TID's hash bucket.
+//
 //==========================================================================
 
 mobj_t *P_FindMobjFromTID(int tid, int *searchPosition)
 {
     int i;
 
-    for (i = *searchPosition + 1; TIDList[i] != 0; i++)
+    if (TIDHash == NULL || tid == 0 || tid == -1)
+    {                           // Never a valid TID in the list
+        *searchPosition = -1;
+        return NULL;
+    }
+
+    i = *searchPosition;
+    if (i >= 0 && i < TIDCount && TIDList[i] == tid)
+    {                           // Continue after the last match
+        i = TIDNext[i];
+    }
+    else
+    {
+        for (i = TIDHash[TIDHASH(tid)]; i != -1 && i <= *searchPosition;
+             i = TIDNext[i]);
+    }
+    for (; i != -1; i = TIDNext[i])
     {
         if (TIDList[i] == tid)
         {
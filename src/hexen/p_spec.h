@@ -547,6 +547,7 @@ void P_PolyobjFinished(int po);
 void P_ACSInitNewGame(void);
 void P_CheckACSStore(void);
 void CheckACSPresent(int number);
+void P_ACSBenchmark(int seconds);
 
 extern int ACScriptCount;
 extern byte *ActionCodeBase;
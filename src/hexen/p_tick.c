@@ -118,6 +118,7 @@ static void RunThinkers(void)
 void P_InitThinkers(void)
 {
     thinkercap.prev = thinkercap.next = &thinkercap;
+    P_ClearMobjTypeLists();     // [crispy] the mobjs are gone, too
 }
 
 //==========================================================================
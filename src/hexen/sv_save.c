@@ -20,6 +20,7 @@
 #include "h2def.h"
 #include "i_system.h"
 #include "m_misc.h"
+#include "m_savefile.h"
 #include "i_swap.h"
 #include "p_local.h"
 
@@ -31,6 +32,7 @@
 #define MAX_MAPS 99
 #define BASE_SLOT 6
 #define REBORN_SLOT 7
+#define GAME_FILE MAX_MAPS      // [crispy] hex<slot>.hxs in a memory slot
 #define REBORN_DESCRIPTION "TEMP GAME"
 #define MAX_THINKER_SIZE 256
 
@@ -84,6 +86,14 @@ typedef struct
     sector_t *sector;
 } ssthinker_t;
 
+// [crispy] a compressed save file held in memory
+
+typedef struct
+{
+    void *data;
+    size_t size;
+} memfile_t;
+
 // EXTERNAL FUNCTION PROTOTYPES --------------------------------------------
 
 void P_SpawnPlayer(mapthing_t * mthing);
@@ -118,10 +128,10 @@ static void RestoreMoveCeiling(ceiling_t * ceiling);
 static void AssertSegment(gameArchiveSegment_t segType);
 static void ClearSaveSlot(int slot);
 static void CopySaveSlot(int sourceSlot, int destSlot);
-static void CopyFile(char *sourceName, char *destName);
+static boolean SlotFileExists(int slot, int map);
 static boolean ExistingFile(char *name);
-static void SV_OpenRead(char *fileName);
-static void SV_OpenWrite(char *fileName);
+static void SV_OpenRead(int map);
+static void SV_OpenWrite(int map);
 static void SV_Close(void);
 static void SV_Read(void *buffer, int size);
 static byte SV_ReadByte(void);
@@ -151,7 +161,14 @@ static mobj_t **MobjList;
 static mobj_t ***TargetPlayerAddrs;
 static int TargetPlayerCount;
 static boolean SavingPlayers;
-static FILE *SavingFP;
+static savefile_t *SavingFP;
+
+// [crispy] The base and reborn slots only ever live in memory, so that
+// map teleports don't have to write, copy and delete files. They are
+// indexed by map number, with the game file itself at GAME_FILE. The
+// disk is only touched when copying from or to a real save slot.
+static memfile_t MemSlots[2][MAX_MAPS + 1];
+static memfile_t *SavingMem;
 
 // CODE --------------------------------------------------------------------
 
@@ -1924,13 +1941,11 @@ static void StreamOut_floorWaggle_t(floorWaggle_t *str)
 
 void SV_SaveGame(int slot, const char *description)
 {
-    char fileName[100];
     char versionText[HXS_VERSION_TEXT_LENGTH];
     unsigned int i;
 
     // Open the output file
-    M_snprintf(fileName, sizeof(fileName), "%shex6.hxs", SavePath);
-    SV_OpenWrite(fileName);
+    SV_OpenWrite(GAME_FILE);
 
     // Write game save description
     SV_Write(description, HXS_DESCRIPTION_LENGTH);
@@ -1984,13 +1999,10 @@ void SV_SaveGame(int slot, const char *description)
 
 void SV_SaveMap(boolean savePlayers)
 {
-    char fileName[100];
-
     SavingPlayers = savePlayers;
 
     // Open the output file
-    M_snprintf(fileName, sizeof(fileName), "%shex6%02d.hxs", SavePath, gamemap);
-    SV_OpenWrite(fileName);
+    SV_OpenWrite(gamemap);
 
     // Place a header marker
     SV_WriteLong(ASEG_MAP_HEADER);
@@ -2025,7 +2037,6 @@ void SV_SaveMap(boolean savePlayers)
 void SV_LoadGame(int slot)
 {
     int i;
-    char fileName[100];
     char version_text[HXS_VERSION_TEXT_LENGTH];
     player_t playerBackup[MAXPLAYERS];
     mobj_t *mobj;
@@ -2037,14 +2048,11 @@ void SV_LoadGame(int slot)
         CopySaveSlot(slot, BASE_SLOT);
     }
 
-    // Create the name
-    M_snprintf(fileName, sizeof(fileName), "%shex6.hxs", SavePath);
-
     // Load the file
-    SV_OpenRead(fileName);
+    SV_OpenRead(GAME_FILE);
 
     // Set the save pointer and skip the description field
-    fseek(SavingFP, HXS_DESCRIPTION_LENGTH, SEEK_CUR);
+    M_SaveFileSeek(SavingFP, HXS_DESCRIPTION_LENGTH, SEEK_CUR);
 
     // Check the version text
 
@@ -2144,7 +2152,6 @@ void SV_MapTeleport(int map, int position)
 {
     int i;
     int j;
-    char fileName[100];
     player_t playerBackup[MAXPLAYERS];
     mobj_t *targetPlayerMobj;
     mobj_t *mobj;
@@ -2186,8 +2193,7 @@ void SV_MapTeleport(int map, int position)
     TargetPlayerAddrs = NULL;
 
     gamemap = map;
-    M_snprintf(fileName, sizeof(fileName), "%shex6%02d.hxs", SavePath, gamemap);
-    if (!deathmatch && ExistingFile(fileName))
+    if (!deathmatch && SlotFileExists(BASE_SLOT, gamemap))
     {                           // Unarchive map
         SV_LoadMap();
     }
@@ -2334,10 +2340,7 @@ int SV_GetRebornSlot(void)
 
 boolean SV_RebornSlotAvailable(void)
 {
-    char fileName[100];
-
-    M_snprintf(fileName, sizeof(fileName), "%shex%d.hxs", SavePath, REBORN_SLOT);
-    return ExistingFile(fileName);
+    return SlotFileExists(REBORN_SLOT, GAME_FILE);
 }
 
 //==========================================================================
@@ -2348,19 +2351,14 @@ boolean SV_RebornSlotAvailable(void)
 
 void SV_LoadMap(void)
 {
-    char fileName[100];
-
     // Load a base level
     G_InitNew(gameskill, gameepisode, gamemap);
 
     // Remove all thinkers
     RemoveAllThinkers();
 
-    // Create the name
-    M_snprintf(fileName, sizeof(fileName), "%shex6%02d.hxs", SavePath, gamemap);
-
     // Load the file
-    SV_OpenRead(fileName);
+    SV_OpenRead(gamemap);
 
     AssertSegment(ASEG_MAP_HEADER);
 
@@ -2648,6 +2646,7 @@ static void UnarchiveMobjs(void)
 
         mobj->thinker.function = P_MobjThinker;
         P_AddThinker(&mobj->thinker);
+        P_InsertMobjIntoTypeList(mobj);
     }
     P_CreateTIDList();
     P_InitCreatureCorpseQueue(true);    // true = scan for corpses
@@ -3184,90 +3183,194 @@ static void AssertSegment(gameArchiveSegment_t segType)
 
 //==========================================================================
 //
-// ClearSaveSlot
+// MemSlotFile
 //
-// Deletes all save game files associated with a slot number.
+// [crispy] Returns the in-memory file for the base and reborn slots, or
+// NULL for slots that are saved to disk.
 //
 //==========================================================================
 
-static void ClearSaveSlot(int slot)
+static memfile_t *MemSlotFile(int slot, int map)
 {
-    int i;
+    if (slot == BASE_SLOT || slot == REBORN_SLOT)
+    {
+        return &MemSlots[slot - BASE_SLOT][map];
+    }
+
+    return NULL;
+}
+
+//==========================================================================
+//
+// SlotFileName
+//
+//==========================================================================
+
+static void SlotFileName(char *name, size_t len, int slot, int map)
+{
+    if (map == GAME_FILE)
+    {
+        M_snprintf(name, len, "%shex%d.hxs", SavePath, slot);
+    }
+    else
+    {
+        M_snprintf(name, len, "%shex%d%02d.hxs", SavePath, slot, map);
+    }
+}
+
+//==========================================================================
+//
+// SlotFileExists
+//
+//==========================================================================
+
+static boolean SlotFileExists(int slot, int map)
+{
+    memfile_t *mem = MemSlotFile(slot, map);
     char fileName[100];
 
-    for (i = 0; i < MAX_MAPS; i++)
+    if (mem != NULL)
     {
-        M_snprintf(fileName, sizeof(fileName),
-                   "%shex%d%02d.hxs", SavePath, slot, i);
-        remove(fileName);
+        return mem->data != NULL;
     }
-    M_snprintf(fileName, sizeof(fileName), "%shex%d.hxs", SavePath, slot);
-    remove(fileName);
+
+    SlotFileName(fileName, sizeof(fileName), slot, map);
+
+    return ExistingFile(fileName);
 }
 
 //==========================================================================
 //
-// CopySaveSlot
+// OpenSlotFile
 //
-// Copies all the save game files from one slot to another.
+// [crispy] The description and version text are kept uncompressed in
+// the game file, so that the menu can read them directly.
 //
 //==========================================================================
 
-static void CopySaveSlot(int sourceSlot, int destSlot)
+static savefile_t *OpenSlotFile(int slot, int map, boolean write)
 {
-    int i;
-    char sourceName[100];
-    char destName[100];
+    const size_t plainsize = map == GAME_FILE ?
+        HXS_DESCRIPTION_LENGTH + HXS_VERSION_TEXT_LENGTH : 0;
+    memfile_t *mem = MemSlotFile(slot, map);
+    char fileName[100];
 
-    for (i = 0; i < MAX_MAPS; i++)
+    if (mem != NULL)
     {
-        M_snprintf(sourceName, sizeof(sourceName),
-                   "%shex%d%02d.hxs", SavePath, sourceSlot, i);
-        if (ExistingFile(sourceName))
+        if (write)
+        {
+            return M_SaveFileOpenMemory(plainsize);
+        }
+
+        if (mem->data == NULL)
         {
-            M_snprintf(destName, sizeof(destName),
-                       "%shex%d%02d.hxs", SavePath, destSlot, i);
-            CopyFile(sourceName, destName);
+            return NULL;
         }
+
+        return M_SaveFileOpenMemRead(mem->data, mem->size, plainsize);
     }
-    M_snprintf(sourceName, sizeof(sourceName),
-               "%shex%d.hxs", SavePath, sourceSlot);
-    if (ExistingFile(sourceName))
+
+    SlotFileName(fileName, sizeof(fileName), slot, map);
+
+    if (write)
     {
-        M_snprintf(destName, sizeof(destName),
-                   "%shex%d.hxs", SavePath, destSlot);
-        CopyFile(sourceName, destName);
+        return M_SaveFileOpenWrite(fileName, plainsize);
     }
-    else
+
+    return M_SaveFileOpenRead(fileName, plainsize);
+}
+
+//==========================================================================
+//
+// CloseSlotFile
+//
+// Closes a file opened with OpenSlotFile() for writing.
+//
+//==========================================================================
+
+static boolean CloseSlotFile(savefile_t *fp, memfile_t *mem)
+{
+    if (mem != NULL)
     {
-        I_Error("Could not load savegame %s", sourceName);
+        free(mem->data);
+        mem->data = M_SaveFileRelease(fp, true, &mem->size);
+
+        return true;
     }
+
+    return M_SaveFileClose(fp);
 }
 
 //==========================================================================
 //
-// CopyFile
+// ClearSaveSlot
+//
+// Deletes all save game files associated with a slot number.
 //
-// This function was rewritten to copy files with minimal strain on zone
-// allocation and allow for big maps that technically work in vanilla to
-// save without error.
 //==========================================================================
 
-static void CopyFile(char *source_name, char *dest_name)
+static void ClearSaveSlot(int slot)
 {
-    const int BUFFER_CHUNK_SIZE = 0x10000;
+    int i;
+    char fileName[100];
+    memfile_t *mem;
+
+    for (i = 0; i <= GAME_FILE; i++)
+    {
+        mem = MemSlotFile(slot, i);
+
+        if (mem != NULL)
+        {
+            free(mem->data);
+            mem->data = NULL;
+            mem->size = 0;
+        }
+        else
+        {
+            SlotFileName(fileName, sizeof(fileName), slot, i);
+            remove(fileName);
+        }
+    }
+}
+
+//==========================================================================
+//
+// CopySlotFile
+//
+// [crispy] Copies a single save game file between slots. Files moving
+// from or to disk are passed through the savefile layer, so that each
+// side ends up in its own (compressed or uncompressed) format.
+//
+//==========================================================================
 
+static void CopySlotFile(int sourceSlot, int destSlot, int map)
+{
+    memfile_t *sourceMem = MemSlotFile(sourceSlot, map);
+    memfile_t *destMem = MemSlotFile(destSlot, map);
+    char fileName[100];
+    savefile_t *source, *dest;
     byte *buffer;
-    int file_length, file_remaining;
-    FILE *read_handle, *write_handle;
-    int buf_count, read_count, write_count;
+    long length;
 
-    read_handle = fopen(source_name, "rb");
-    if (read_handle == NULL)
+    if (sourceMem != NULL && destMem != NULL)
     {
-        I_Error ("Couldn't read file %s", source_name);
+        free(destMem->data);
+        destMem->data = malloc(sourceMem->size);
+        destMem->size = sourceMem->size;
+        memcpy(destMem->data, sourceMem->data, sourceMem->size);
+        return;
     }
-    file_length = file_remaining = M_FileLength(read_handle);
+
+    source = OpenSlotFile(sourceSlot, map, false);
+    if (source == NULL)
+    {
+        SlotFileName(fileName, sizeof(fileName), sourceSlot, map);
+        I_Error("Couldn't read file %s", fileName);
+    }
+
+    M_SaveFileSeek(source, 0, SEEK_END);
+    length = M_SaveFileTell(source);
+    M_SaveFileSeek(source, 0, SEEK_SET);
 
     // Vanilla savegame emulation.
     //
@@ -3277,44 +3380,55 @@ static void CopyFile(char *source_name, char *dest_name)
 
     if (vanilla_savegame_limit)
     {
-        buffer = Z_Malloc(file_length, PU_STATIC, NULL);
+        buffer = Z_Malloc(length, PU_STATIC, NULL);
         Z_Free(buffer);
     }
 
-    write_handle = fopen(dest_name, "wb");
-    if (write_handle == NULL)
+    buffer = malloc(length);
+    M_SaveFileRead(buffer, length, source);
+    M_SaveFileClose(source);
+
+    dest = OpenSlotFile(destSlot, map, true);
+    if (dest == NULL
+     || M_SaveFileWrite(buffer, length, dest) != (size_t) length
+     || !CloseSlotFile(dest, destMem))
     {
-        I_Error ("Couldn't read file %s", dest_name);
+        SlotFileName(fileName, sizeof(fileName), destSlot, map);
+        I_Error("Couldn't write to file %s", fileName);
     }
 
-    buffer = Z_Malloc (BUFFER_CHUNK_SIZE, PU_STATIC, NULL);
+    free(buffer);
+}
 
-    do
-    {
-        buf_count = BUFFER_CHUNK_SIZE;
-        if( file_remaining < BUFFER_CHUNK_SIZE)
-        {
-            buf_count = file_remaining;
-        }
+//==========================================================================
+//
+// CopySaveSlot
+//
+// Copies all the save game files from one slot to another.
+//
+//==========================================================================
 
-        read_count = fread(buffer, 1, buf_count, read_handle);
-        if (read_count < buf_count)
-        {
-            I_Error ("Couldn't read file %s", source_name);
-        }
+static void CopySaveSlot(int sourceSlot, int destSlot)
+{
+    int i;
+    char fileName[100];
 
-        write_count = fwrite(buffer, 1, buf_count, write_handle);
-        if (write_count < buf_count)
+    for (i = 0; i < MAX_MAPS; i++)
+    {
+        if (SlotFileExists(sourceSlot, i))
         {
-            I_Error ("Couldn't write to file %s", dest_name);
+            CopySlotFile(sourceSlot, destSlot, i);
         }
-
-        file_remaining -= buf_count;
-    } while (file_remaining > 0);
-
-    Z_Free(buffer);
-    fclose(read_handle);
-    fclose(write_handle);
+    }
+    if (SlotFileExists(sourceSlot, GAME_FILE))
+    {
+        CopySlotFile(sourceSlot, destSlot, GAME_FILE);
+    }
+    else
+    {
+        SlotFileName(fileName, sizeof(fileName), sourceSlot, GAME_FILE);
+        I_Error("Could not load savegame %s", fileName);
+    }
 }
 
 //==========================================================================
@@ -3344,20 +3458,39 @@ static boolean ExistingFile(char *name)
 //
 //==========================================================================
 
-static void SV_OpenRead(char *fileName)
+// [crispy] all reading and writing goes through the base slot, which
+// is kept in memory
+
+static void SV_OpenRead(int map)
 {
-    SavingFP = fopen(fileName, "rb");
+    char fileName[100];
+
+    SV_Close();
 
-    // Should never happen, only if hex6.hxs cannot ever be created.
+    SavingFP = OpenSlotFile(BASE_SLOT, map, false);
+
+    // Should never happen, only if the base slot was never written.
     if (SavingFP == NULL)
     {
+        SlotFileName(fileName, sizeof(fileName), BASE_SLOT, map);
         I_Error("Could not load savegame %s", fileName);
     }
 }
 
-static void SV_OpenWrite(char *fileName)
+static void SV_OpenWrite(int map)
 {
-    SavingFP = fopen(fileName, "wb");
+    char fileName[100];
+
+    SV_Close();
+
+    SavingFP = OpenSlotFile(BASE_SLOT, map, true);
+    SavingMem = MemSlotFile(BASE_SLOT, map);
+
+    if (SavingFP == NULL)
+    {
+        SlotFileName(fileName, sizeof(fileName), BASE_SLOT, map);
+        I_Error("Could not save game to %s", fileName);
+    }
 }
 
 //==========================================================================
@@ -3370,7 +3503,17 @@ static void SV_Close(void)
 {
     if (SavingFP)
     {
-        fclose(SavingFP);
+        if (SavingMem != NULL)
+        {
+            CloseSlotFile(SavingFP, SavingMem);
+        }
+        else if (!M_SaveFileClose(SavingFP))
+        {
+            fprintf(stderr, "SV_Close: Error while writing save game\n");
+        }
+
+        SavingFP = NULL;
+        SavingMem = NULL;
     }
 }
 
@@ -3382,7 +3525,7 @@ static void SV_Close(void)
 
 static void SV_Read(void *buffer, int size)
 {
-    int retval = fread(buffer, 1, size, SavingFP);
+    int retval = M_SaveFileRead(buffer, size, SavingFP);
     if (retval != size)
     {
         I_Error("Incomplete read in SV_Read: Expected %d, got %d bytes",
@@ -3424,24 +3567,24 @@ static void *SV_ReadPtr(void)
 
 static void SV_Write(const void *buffer, int size)
 {
-    fwrite(buffer, size, 1, SavingFP);
+    M_SaveFileWrite(buffer, size, SavingFP);
 }
 
 static void SV_WriteByte(byte val)
 {
-    fwrite(&val, sizeof(byte), 1, SavingFP);
+    M_SaveFilePutc(val, SavingFP);
 }
 
 static void SV_WriteWord(unsigned short val)
 {
     val = SHORT(val);
-    fwrite(&val, sizeof(unsigned short), 1, SavingFP);
+    M_SaveFileWrite(&val, sizeof(unsigned short), SavingFP);
 }
 
 static void SV_WriteLong(unsigned int val)
 {
     val = LONG(val);
-    fwrite(&val, sizeof(int), 1, SavingFP);
+    M_SaveFileWrite(&val, sizeof(int), SavingFP);
 }
 
 static void SV_WritePtr(void *val)
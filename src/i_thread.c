@@ -0,0 +1,138 @@
+//
+// Copyright(C) 2026 Fabian Greffrath
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      [crispy] Worker thread pool.
+//
+
+#include <stdio.h>
+
+#include "SDL.h"
+
+#include "i_system.h"
+#include "i_thread.h"
+#include "doomtype.h"
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_sem *start;
+    int index;
+} worker_t;
+
+static worker_t workers[MAXTHREADS];
+static int numthreads = 1;
+
+static SDL_sem *done;
+
+static thread_func_t job_func;
+static void *job_data;
+
+static int WorkerThread(void *arg)
+{
+    worker_t *worker = arg;
+
+    for (;;)
+    {
+        SDL_SemWait(worker->start);
+
+        job_func(worker->index, numthreads, job_data);
+
+        SDL_SemPost(done);
+    }
+
+    return 0;
+}
+
+void I_InitThreads(int count)
+{
+    int i;
+
+    if (numthreads > 1)
+    {
+        return;
+    }
+
+    if (count <= 0)
+    {
+        count = SDL_GetCPUCount();
+    }
+
+    if (count > MAXTHREADS)
+    {
+        count = MAXTHREADS;
+    }
+
+    if (count <= 1)
+    {
+        return;
+    }
+
+    done = SDL_CreateSemaphore(0);
+
+    if (done == NULL)
+    {
+        I_Error("I_InitThreads: %s", SDL_GetError());
+    }
+
+    // Thread 0 is the calling thread, so only start the others.
+
+    for (i = 1; i < count; ++i)
+    {
+        workers[i].index = i;
+        workers[i].start = SDL_CreateSemaphore(0);
+        workers[i].thread = SDL_CreateThread(WorkerThread, "worker",
+                                             &workers[i]);
+
+        if (workers[i].start == NULL || workers[i].thread == NULL)
+        {
+            I_Error("I_InitThreads: %s", SDL_GetError());
+        }
+    }
+
+    numthreads = count;
+
+    printf("I_InitThreads: %d threads.\n", numthreads);
+}
+
+int I_NumThreads(void)
+{
+    return numthreads;
+}
+
+void I_RunThreads(thread_func_t func, void *data)
+{
+    int i;
+
+    if (numthreads <= 1)
+    {
+        func(0, 1, data);
+        return;
+    }
+
+    job_func = func;
+    job_data = data;
+
+    for (i = 1; i < numthreads; ++i)
+    {
+        SDL_SemPost(workers[i].start);
+    }
+
+    func(0, numthreads, data);
+
+    for (i = 1; i < numthreads; ++i)
+    {
+        SDL_SemWait(done);
+    }
+}
+
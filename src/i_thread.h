@@ -0,0 +1,40 @@
+//
+// Copyright(C) 2026 Fabian Greffrath
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      [crispy] Worker thread pool interface
+//
+
+
+#ifndef __I_THREAD__
+#define __I_THREAD__
+
+#define MAXTHREADS 16
+
+// Function run on each thread by I_RunThreads(). "index" identifies
+// the calling thread and runs from 0 to "count" - 1.
+typedef void (*thread_func_t)(int index, int count, void *data);
+
+// Start the worker threads. "count" includes the calling thread;
+// zero means one thread per CPU.
+void I_InitThreads(int count);
+
+// Number of threads that I_RunThreads() will use.
+int I_NumThreads(void);
+
+// Run func on all threads (including the calling thread, which gets
+// index 0) and wait until every thread has returned.
+void I_RunThreads(thread_func_t func, void *data);
+
+#endif
+
@@ -58,6 +58,31 @@ int I_GetTimeMS(void)
     return ticks - basetime;
 }
 
+//
+// [crispy] Same as I_GetTimeMS, but returns time in microseconds
+// from the high-resolution performance counter
+//
+
+uint64_t I_GetTimeUS(void)
+{
+    static Uint64 basecount = 0, frequency;
+    Uint64 count;
+
+    count = SDL_GetPerformanceCounter();
+
+    if (basecount == 0)
+    {
+        basecount = count;
+        frequency = SDL_GetPerformanceFrequency();
+    }
+
+    count -= basecount;
+
+    // split the conversion to keep count * 1000000 from overflowing
+    return (count / frequency) * 1000000 +
+           (count % frequency) * 1000000 / frequency;
+}
+
 // Sleep for a specified number of ms
 
 void I_Sleep(int ms)
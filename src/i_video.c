@@ -104,6 +104,19 @@ static SDL_Color palette[256];
 #endif
 static boolean palette_to_set;
 
+#ifndef CRISPY_TRUECOLOR
+// [crispy] pipelined frame presentation: each finished frame is copied
+// into presentbuffer and converted into argbbuffer on presentthread,
+// then uploaded and presented at the start of the next I_FinishUpdate()
+
+static SDL_Thread *presentthread = NULL;
+static SDL_sem *presentstart, *presentdone;
+static byte *presentbuffer = NULL;
+static uint32_t presentpalette[256];
+static boolean presentpending = false;
+static boolean porch_to_set = false;
+#endif
+
 // display has been set up?
 
 static boolean initialized = false;
@@ -159,6 +172,11 @@ int integer_scaling = false;
 
 int vga_porch_flash = false;
 
+// [crispy] Convert the paletted frame on a separate thread while the
+// game carries on with the next one; this delays the image by one frame
+
+int present_thread = false;
+
 // Force software rendering, for systems which lack effective hardware
 // acceleration
 
@@ -284,10 +302,93 @@ static void SetShowCursor(boolean show)
     }
 }
 
+#ifndef CRISPY_TRUECOLOR
+static int PresentThread(void *unused)
+{
+    for (;;)
+    {
+        const byte *src;
+        int x, y;
+
+        SDL_SemWait(presentstart);
+
+        src = presentbuffer;
+
+        for (y = 0; y < SCREENHEIGHT; y++)
+        {
+            uint32_t *dest = (uint32_t *) ((byte *) argbbuffer->pixels +
+                                           y * argbbuffer->pitch);
+
+            for (x = 0; x < SCREENWIDTH; x++)
+            {
+                dest[x] = presentpalette[*src++];
+            }
+        }
+
+        SDL_SemPost(presentdone);
+    }
+
+    return 0;
+}
+
+// Start the present thread on first use. Falls back to presenting on
+// the game thread if the thread can not be created or the intermediate
+// buffer is not 32 bits per pixel.
+
+static boolean StartPresentThread(void)
+{
+    if (presentthread != NULL)
+    {
+        return true;
+    }
+
+    if (argbbuffer->format->BytesPerPixel != 4)
+    {
+        present_thread = false;
+        return false;
+    }
+
+    presentbuffer = malloc(MAXWIDTH * MAXHEIGHT);
+    presentstart = SDL_CreateSemaphore(0);
+    presentdone = SDL_CreateSemaphore(0);
+    presentthread = SDL_CreateThread(PresentThread, "present", NULL);
+
+    if (presentthread == NULL)
+    {
+        fprintf(stderr, "StartPresentThread: %s\n", SDL_GetError());
+        SDL_DestroySemaphore(presentstart);
+        SDL_DestroySemaphore(presentdone);
+        free(presentbuffer);
+        presentbuffer = NULL;
+        present_thread = false;
+        return false;
+    }
+
+    // build presentpalette
+    palette_to_set = true;
+
+    return true;
+}
+
+// Wait for the frame in flight, it is dropped without being presented.
+
+static void FinishPresentThread(void)
+{
+    if (presentpending)
+    {
+        SDL_SemWait(presentdone);
+        presentpending = false;
+    }
+}
+#endif
+
 void I_ShutdownGraphics(void)
 {
     if (initialized)
     {
+#ifndef CRISPY_TRUECOLOR
+        FinishPresentThread(); // [crispy]
+#endif
         SetShowCursor(true);
 
         SDL_QuitSubSystem(SDL_INIT_VIDEO);
@@ -712,6 +813,46 @@ static void CreateUpscaledTexture(boolean force)
 //      range of [0.0, 1.0).  Used for interpolation.
 fixed_t fractionaltic;
 
+// [crispy] render the intermediate texture to screen
+
+static void RenderTexture(void)
+{
+    // Make sure the pillarboxes are kept clear each frame.
+
+    SDL_RenderClear(renderer);
+
+    if (crispy->smoothscaling)
+    {
+    // Render this intermediate texture into the upscaled texture
+    // using "nearest" integer scaling.
+
+    SDL_SetRenderTarget(renderer, texture_upscaled);
+    SDL_RenderCopy(renderer, texture, NULL, NULL);
+
+    // Finally, render this upscaled texture to screen using linear scaling.
+
+    SDL_SetRenderTarget(renderer, NULL);
+    SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
+    }
+    else
+    {
+	SDL_SetRenderTarget(renderer, NULL);
+	SDL_RenderCopy(renderer, texture, NULL, NULL);
+    }
+
+#ifdef CRISPY_TRUECOLOR
+    if (curpane)
+    {
+	SDL_SetTextureAlphaMod(curpane, pane_alpha);
+	SDL_RenderCopy(renderer, curpane, NULL, NULL);
+    }
+#endif
+
+    // Draw!
+
+    SDL_RenderPresent(renderer);
+}
+
 //
 // I_FinishUpdate
 //
@@ -808,6 +949,70 @@ void I_FinishUpdate (void)
 		}
 	}
 
+#ifndef CRISPY_TRUECOLOR
+    // [crispy] pipelined frame presentation, but present synchronously
+    // when something wants to act on the finished frame right after
+    if (present_thread && !crispy->post_rendering_hook && StartPresentThread())
+    {
+        // Upload the previous frame, once it has been converted.
+
+        if (presentpending)
+        {
+            SDL_SemWait(presentdone);
+            SDL_UpdateTexture(texture, NULL, argbbuffer->pixels, argbbuffer->pitch);
+        }
+
+        // Hand this frame over including the disk icon, so that the game
+        // can carry on drawing into I_VideoBuffer right away.
+
+        V_DrawDiskIcon();
+        memcpy(presentbuffer, I_VideoBuffer, SCREENWIDTH * SCREENHEIGHT);
+        V_RestoreDiskBackground();
+
+        if (palette_to_set)
+        {
+            for (i = 0; i < 256; i++)
+            {
+                presentpalette[i] = SDL_MapRGB(argbbuffer->format, palette[i].r,
+                                               palette[i].g, palette[i].b);
+            }
+
+            // keep the palette for the synchronous path up to date
+            SDL_SetPaletteColors(screenbuffer->format->palette, palette, 0, 256);
+            palette_to_set = false;
+            porch_to_set = vga_porch_flash;
+        }
+
+        SDL_SemPost(presentstart);
+
+        if (presentpending)
+        {
+            RenderTexture();
+        }
+
+        presentpending = true;
+
+        // The pillars/letterboxes flash along with the frame that
+        // changed the palette, which is presented next time.
+
+        if (porch_to_set)
+        {
+            SDL_SetRenderDrawColor(renderer, palette[0].r, palette[0].g,
+                palette[0].b, SDL_ALPHA_OPAQUE);
+            porch_to_set = false;
+        }
+
+        if (crispy->uncapped)
+        {
+            fractionaltic = I_GetTimeMS() * TICRATE % 1000 * FRACUNIT / 1000;
+        }
+
+        return;
+    }
+
+    FinishPresentThread();
+#endif
+
     // Draw disk icon before blit, if necessary.
     V_DrawDiskIcon();
 
@@ -836,40 +1041,7 @@ void I_FinishUpdate (void)
 
     SDL_UpdateTexture(texture, NULL, argbbuffer->pixels, argbbuffer->pitch);
 
-    // Make sure the pillarboxes are kept clear each frame.
-
-    SDL_RenderClear(renderer);
-
-    if (crispy->smoothscaling)
-    {
-    // Render this intermediate texture into the upscaled texture
-    // using "nearest" integer scaling.
-
-    SDL_SetRenderTarget(renderer, texture_upscaled);
-    SDL_RenderCopy(renderer, texture, NULL, NULL);
-
-    // Finally, render this upscaled texture to screen using linear scaling.
-
-    SDL_SetRenderTarget(renderer, NULL);
-    SDL_RenderCopy(renderer, texture_upscaled, NULL, NULL);
-    }
-    else
-    {
-	SDL_SetRenderTarget(renderer, NULL);
-	SDL_RenderCopy(renderer, texture, NULL, NULL);
-    }
-
-#ifdef CRISPY_TRUECOLOR
-    if (curpane)
-    {
-	SDL_SetTextureAlphaMod(curpane, pane_alpha);
-	SDL_RenderCopy(renderer, curpane, NULL, NULL);
-    }
-#endif
-
-    // Draw!
-
-    SDL_RenderPresent(renderer);
+    RenderTexture();
 
     // [AM] Figure out how far into the current tic we're in as a fixed_t.
     if (crispy->uncapped)
@@ -1688,6 +1860,11 @@ void I_ReInitGraphics (int reinit)
 		unsigned int rmask, gmask, bmask, amask;
 		int unused_bpp;
 
+#ifndef CRISPY_TRUECOLOR
+		// [crispy] argbbuffer may still be in use by the present thread
+		FinishPresentThread();
+#endif
+
 		I_GetScreenDimensions();
 
 #ifndef CRISPY_TRUECOLOR
@@ -1888,6 +2065,7 @@ void I_BindVideoVariables(void)
     M_BindIntVariable("aspect_ratio_correct",      &aspect_ratio_correct);
     M_BindIntVariable("integer_scaling",           &integer_scaling);
     M_BindIntVariable("vga_porch_flash",           &vga_porch_flash);
+    M_BindIntVariable("present_thread",            &present_thread);
     M_BindIntVariable("startup_delay",             &startup_delay);
     M_BindIntVariable("fullscreen_width",          &fullscreen_width);
     M_BindIntVariable("fullscreen_height",         &fullscreen_height);
@@ -794,6 +794,14 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(vga_porch_flash),
 
+    //!
+    // If non-zero, each frame is converted to 32-bit color on a separate
+    // thread while the game draws the next one. Frames reach the screen
+    // one frame later.
+    //
+
+    CONFIG_VARIABLE_INT(present_thread),
+
     //!
     // Window width when running in windowed mode.
     //
@@ -1041,6 +1049,14 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(vanilla_demo_limit),
 
+    //!
+    // If non-zero, savegames are written compressed with zlib. Only the
+    // description at the start of the file is kept uncompressed.
+    // Compressed and uncompressed savegames can both be loaded.
+    //
+
+    CONFIG_VARIABLE_INT(savegame_compression),
+
     //!
     // If non-zero, the game behaves like Vanilla Doom, always assuming
     // an American keyboard mapping.  If this has a value of zero, the
@@ -2025,6 +2041,16 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(crispy_flipcorpses),
 
+    //!
+    // @game doom
+    //
+    // Frame time budget in milliseconds for the 3D view. When set, the
+    // view drops to low detail while rendering takes longer than this
+    // and returns to high detail once it fits again. 0 disables.
+    //
+
+    CONFIG_VARIABLE_INT(crispy_framebudget),
+
     //!
     // @game doom
     //
@@ -2113,6 +2139,14 @@ static default_t extra_defaults_list[] =
 
     CONFIG_VARIABLE_INT(crispy_recoil),
 
+    //!
+    // @game doom
+    //
+    // Number of threads used for rendering, 0 for one per CPU.
+    //
+
+    CONFIG_VARIABLE_INT(crispy_renderthreads),
+
     //!
     // @game doom
     //
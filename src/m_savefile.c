@@ -0,0 +1,469 @@
+//
+// Copyright(C) 2026 Fabian Greffrath
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      [crispy] Buffered savegame file I/O shared by all games.
+//
+//      Savegames are built up in a growable memory buffer and written
+//      out in one go when closed. When loading, the whole file is read
+//      into memory at once. Compressed savegames keep the uncompressed
+//      description in front, followed by a small header and the zlib
+//      stream of the remaining data:
+//
+//      description | "\x1fSVZ" | uncompressed size (32-bit LE) | zlib data
+//
+//      Files can also live entirely in memory, and be handed over as
+//      (optionally compressed) blobs in the very same format.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config.h"
+
+#ifdef HAVE_LIBZ
+#include <zlib.h>
+#endif
+
+#include "i_system.h"
+#include "m_savefile.h"
+
+#define SAVEFILE_MAGIC "\x1fSVZ"
+#define SAVEFILE_MAGICLEN 4
+#define SAVEFILE_HEADERLEN (SAVEFILE_MAGICLEN + 4)
+#define SAVEFILE_MAXSIZE (256 * 1024 * 1024)
+
+int savegame_compression = 0;
+
+struct savefile_s
+{
+    FILE *stream;       // only for files written to disk
+    boolean writing;
+    byte *data;
+    size_t size;
+    size_t alloced;
+    size_t pos;
+    size_t plainsize;
+};
+
+static savefile_t *NewSaveFile(size_t plainsize)
+{
+    savefile_t *file;
+
+    file = calloc(1, sizeof(*file));
+    file->plainsize = plainsize;
+
+    return file;
+}
+
+static void FreeSaveFile(savefile_t *file)
+{
+    free(file->data);
+    free(file);
+}
+
+// Decompress the data following the description, if it is compressed.
+
+static boolean InflateSaveFile(savefile_t *file)
+{
+    const byte *header = file->data + file->plainsize;
+
+    if (file->size < file->plainsize + SAVEFILE_HEADERLEN
+     || memcmp(header, SAVEFILE_MAGIC, SAVEFILE_MAGICLEN) != 0)
+    {
+        return true;
+    }
+
+#ifdef HAVE_LIBZ
+    {
+        byte *data;
+        size_t length;
+        uLongf destlen;
+
+        length = header[4] | (header[5] << 8) | (header[6] << 16)
+               | ((size_t) header[7] << 24);
+
+        // No savegame comes anywhere near this size, so the header
+        // must be damaged.
+        if (length > SAVEFILE_MAXSIZE)
+        {
+            fprintf(stderr, "InflateSaveFile: Corrupt compressed savegame\n");
+            return false;
+        }
+
+        destlen = length;
+        data = I_Realloc(NULL, file->plainsize + length);
+        memcpy(data, file->data, file->plainsize);
+
+        if (uncompress(data + file->plainsize, &destlen,
+                       header + SAVEFILE_HEADERLEN,
+                       file->size - file->plainsize - SAVEFILE_HEADERLEN) != Z_OK
+         || destlen != length)
+        {
+            fprintf(stderr, "InflateSaveFile: Corrupt compressed savegame\n");
+            free(data);
+            return false;
+        }
+
+        free(file->data);
+        file->data = data;
+        file->size = file->alloced = file->plainsize + length;
+
+        return true;
+    }
+#else
+    fprintf(stderr, "InflateSaveFile: Compressed savegames need zlib\n");
+    return false;
+#endif
+}
+
+savefile_t *M_SaveFileOpenRead(const char *filename, size_t plainsize)
+{
+    savefile_t *file;
+    FILE *stream;
+    long length;
+
+    stream = fopen(filename, "rb");
+
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+
+    file = NewSaveFile(plainsize);
+
+    if (fseek(stream, 0, SEEK_END) != 0 || (length = ftell(stream)) < 0
+     || fseek(stream, 0, SEEK_SET) != 0)
+    {
+        fclose(stream);
+        FreeSaveFile(file);
+        return NULL;
+    }
+
+    file->alloced = length;
+    file->data = malloc(length + 1);
+    file->size = fread(file->data, 1, length, stream);
+    fclose(stream);
+
+    if (!InflateSaveFile(file))
+    {
+        FreeSaveFile(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+savefile_t *M_SaveFileOpenWrite(const char *filename, size_t plainsize)
+{
+    savefile_t *file;
+    FILE *stream;
+
+    stream = fopen(filename, "wb");
+
+    if (stream == NULL)
+    {
+        return NULL;
+    }
+
+    file = M_SaveFileOpenMemory(plainsize);
+    file->stream = stream;
+
+    return file;
+}
+
+savefile_t *M_SaveFileOpenMemRead(const void *data, size_t size,
+                                  size_t plainsize)
+{
+    savefile_t *file;
+
+    file = NewSaveFile(plainsize);
+    file->alloced = file->size = size;
+    file->data = malloc(size + 1);
+    memcpy(file->data, data, size);
+
+    if (!InflateSaveFile(file))
+    {
+        FreeSaveFile(file);
+        return NULL;
+    }
+
+    return file;
+}
+
+savefile_t *M_SaveFileOpenMemory(size_t plainsize)
+{
+    savefile_t *file;
+
+    file = NewSaveFile(plainsize);
+    file->writing = true;
+    file->alloced = 64 * 1024;
+    file->data = malloc(file->alloced);
+
+    return file;
+}
+
+// Compress everything after the description into a new buffer holding
+// the complete file. Returns NULL if that is not possible.
+
+static byte *DeflateSaveFile(savefile_t *file, size_t *size)
+{
+#ifdef HAVE_LIBZ
+    if (file->size > file->plainsize)
+    {
+        const size_t length = file->size - file->plainsize;
+        uLongf destlen = compressBound(length);
+        byte *data, *header;
+
+        data = malloc(file->plainsize + SAVEFILE_HEADERLEN + destlen);
+        header = data + file->plainsize;
+
+        if (compress2(header + SAVEFILE_HEADERLEN, &destlen,
+                      file->data + file->plainsize, length,
+                      Z_BEST_SPEED) == Z_OK)
+        {
+            memcpy(data, file->data, file->plainsize);
+            memcpy(header, SAVEFILE_MAGIC, SAVEFILE_MAGICLEN);
+            header[4] = length & 0xff;
+            header[5] = (length >> 8) & 0xff;
+            header[6] = (length >> 16) & 0xff;
+            header[7] = (length >> 24) & 0xff;
+
+            *size = file->plainsize + SAVEFILE_HEADERLEN + destlen;
+
+            return data;
+        }
+
+        free(data);
+    }
+#endif
+
+    return NULL;
+}
+
+// Write out the buffer, compressing everything after the description
+// if requested. Falls back to writing it uncompressed.
+
+static boolean WriteSaveFile(savefile_t *file)
+{
+    FILE *stream = file->stream;
+
+    if (savegame_compression)
+    {
+        byte *data;
+        size_t size;
+
+        data = DeflateSaveFile(file, &size);
+
+        if (data != NULL)
+        {
+            boolean result;
+
+            result = fwrite(data, 1, size, stream) == size;
+            free(data);
+
+            return result;
+        }
+    }
+
+    return fwrite(file->data, 1, file->size, stream) == file->size;
+}
+
+void *M_SaveFileRelease(savefile_t *file, boolean compress, size_t *size)
+{
+    byte *data = NULL;
+
+    if (compress)
+    {
+        data = DeflateSaveFile(file, size);
+    }
+
+    if (data == NULL)
+    {
+        data = file->data;
+        *size = file->size;
+        file->data = NULL;
+    }
+
+    if (file->stream != NULL)
+    {
+        fclose(file->stream);
+    }
+
+    FreeSaveFile(file);
+
+    return data;
+}
+
+boolean M_SaveFileClose(savefile_t *file)
+{
+    boolean result = true;
+
+    if (file->stream != NULL)
+    {
+        result = WriteSaveFile(file);
+
+        if (fclose(file->stream) != 0)
+        {
+            result = false;
+        }
+    }
+
+    FreeSaveFile(file);
+
+    return result;
+}
+
+int M_SaveFileGetc(savefile_t *file)
+{
+    if (file->pos >= file->size)
+    {
+        return EOF;
+    }
+
+    return file->data[file->pos++];
+}
+
+size_t M_SaveFileRead(void *buf, size_t size, savefile_t *file)
+{
+    if (file->pos >= file->size)
+    {
+        return 0;
+    }
+
+    if (size > file->size - file->pos)
+    {
+        size = file->size - file->pos;
+    }
+
+    memcpy(buf, file->data + file->pos, size);
+    file->pos += size;
+
+    return size;
+}
+
+size_t M_SaveFileWrite(const void *buf, size_t size, savefile_t *file)
+{
+    if (!file->writing)
+    {
+        return 0;
+    }
+
+    if (file->pos + size > file->alloced)
+    {
+        while (file->pos + size > file->alloced)
+        {
+            file->alloced *= 2;
+        }
+
+        file->data = I_Realloc(file->data, file->alloced);
+    }
+
+    memcpy(file->data + file->pos, buf, size);
+    file->pos += size;
+
+    if (file->pos > file->size)
+    {
+        file->size = file->pos;
+    }
+
+    return size;
+}
+
+int M_SaveFilePutc(int c, savefile_t *file)
+{
+    byte b = c;
+
+    if (file->writing && file->pos < file->alloced)
+    {
+        file->data[file->pos++] = b;
+
+        if (file->pos > file->size)
+        {
+            file->size = file->pos;
+        }
+
+        return b;
+    }
+
+    return M_SaveFileWrite(&b, 1, file) == 1 ? b : EOF;
+}
+
+char *M_SaveFileGets(char *buf, int size, savefile_t *file)
+{
+    int i = 0;
+
+    if (size <= 0 || file->pos >= file->size)
+    {
+        return NULL;
+    }
+
+    while (i < size - 1 && file->pos < file->size)
+    {
+        buf[i] = file->data[file->pos++];
+
+        if (buf[i++] == '\n')
+        {
+            break;
+        }
+    }
+
+    buf[i] = '\0';
+
+    return buf;
+}
+
+int M_SaveFilePuts(const char *buf, savefile_t *file)
+{
+    const size_t size = strlen(buf);
+
+    return M_SaveFileWrite(buf, size, file) == size ? 0 : EOF;
+}
+
+long M_SaveFileTell(savefile_t *file)
+{
+    return file->pos;
+}
+
+int M_SaveFileSeek(savefile_t *file, long offset, int whence)
+{
+    long pos;
+
+    switch (whence)
+    {
+        case SEEK_SET:
+            pos = offset;
+            break;
+
+        case SEEK_CUR:
+            pos = file->pos + offset;
+            break;
+
+        case SEEK_END:
+            pos = file->size + offset;
+            break;
+
+        default:
+            return -1;
+    }
+
+    if (pos < 0 || (size_t) pos > file->size)
+    {
+        return -1;
+    }
+
+    file->pos = pos;
+
+    return 0;
+}
@@ -0,0 +1,61 @@
+//
+// Copyright(C) 2026 Fabian Greffrath
+//
+// This program is free software; you can redistribute it and/or
+// modify it under the terms of the GNU General Public License
+// as published by the Free Software Foundation; either version 2
+// of the License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// DESCRIPTION:
+//      [crispy] Buffered savegame file I/O shared by all games.
+//
+
+#ifndef __M_SAVEFILE__
+#define __M_SAVEFILE__
+
+#include "doomtype.h"
+
+typedef struct savefile_s savefile_t;
+
+// Compress savegames written from now on (needs zlib).
+
+extern int savegame_compression;
+
+// The first "plainsize" bytes of a savegame (its description) are
+// always stored uncompressed, so that the menus can still peek at them.
+
+savefile_t *M_SaveFileOpenRead(const char *filename, size_t plainsize);
+savefile_t *M_SaveFileOpenWrite(const char *filename, size_t plainsize);
+
+// In-memory savegames: OpenMemRead reads from a copy of a blob returned
+// by M_SaveFileRelease, OpenMemory writes to memory only.
+
+savefile_t *M_SaveFileOpenMemRead(const void *data, size_t size,
+                                  size_t plainsize);
+savefile_t *M_SaveFileOpenMemory(size_t plainsize);
+
+// Closes the file and hands over its contents as a blob, to be freed
+// with free(). The blob is compressed if requested and possible.
+
+void *M_SaveFileRelease(savefile_t *file, boolean compress, size_t *size);
+
+// Writes out the whole file, if open for writing. Returns false if
+// anything went wrong while writing.
+
+boolean M_SaveFileClose(savefile_t *file);
+
+int M_SaveFileGetc(savefile_t *file);
+int M_SaveFilePutc(int c, savefile_t *file);
+size_t M_SaveFileRead(void *buf, size_t size, savefile_t *file);
+size_t M_SaveFileWrite(const void *buf, size_t size, savefile_t *file);
+char *M_SaveFileGets(char *buf, int size, savefile_t *file);
+int M_SaveFilePuts(const char *buf, savefile_t *file);
+long M_SaveFileTell(savefile_t *file);
+int M_SaveFileSeek(savefile_t *file, long offset, int whence);
+
+#endif
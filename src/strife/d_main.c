@@ -54,6 +54,7 @@
 #include "m_misc.h"
 #include "m_menu.h"
 #include "m_saves.h" // haleyjd [STRIFE]
+#include "m_savefile.h" // [crispy] savegame_compression
 #include "p_saveg.h"
 #include "p_dialog.h" // haleyjd [STRIFE]
 
@@ -445,6 +446,7 @@ void D_BindVariables(void)
     M_BindIntVariable("snd_channels",           &snd_channels);
     M_BindIntVariable("vanilla_savegame_limit", &vanilla_savegame_limit);
     M_BindIntVariable("vanilla_demo_limit",     &vanilla_demo_limit);
+    M_BindIntVariable("savegame_compression",   &savegame_compression);
     M_BindIntVariable("show_endoom",            &show_endoom);
     M_BindIntVariable("show_diskicon",          &show_diskicon);
     M_BindIntVariable("graphical_startup",      &graphical_startup);
@@ -1680,7 +1680,8 @@ void G_DoLoadGame (boolean userload)
 
     gameaction = ga_nothing;
 
-    save_stream = fopen(loadpath, "rb");
+    // [crispy] loadpath always points into the in-memory temporary slot
+    save_stream = M_TmpOpenRead(M_BaseName(loadpath));
 
     // [STRIFE] If the file does not exist, G_DoLoadLevel is called.
     if (save_stream == NULL)
@@ -1693,7 +1694,7 @@ void G_DoLoadGame (boolean userload)
 
     if (!P_ReadSaveGameHeader())
     {
-        fclose(save_stream);
+        M_SaveFileClose(save_stream);
         return;
     }
 
@@ -1723,7 +1724,7 @@ void G_DoLoadGame (boolean userload)
     if (!P_ReadSaveGameEOF())
         I_Error ("Bad savegame");
 
-    fclose(save_stream);
+    M_SaveFileClose(save_stream);
     
     if (setsizeneeded)
         R_ExecuteSetViewSize ();
@@ -1742,8 +1743,6 @@ void G_DoLoadGame (boolean userload)
 boolean G_WriteSaveName(int slot, const char *charname)
 {
     //char savedir[16];
-    char *tmpname;
-    boolean retval;
 
     savegameslot = slot;
 
@@ -1765,15 +1764,11 @@ boolean G_WriteSaveName(int slot, const char *charname)
     memset(character_name, 0, CHARACTER_NAME_LEN);
     M_StringCopy(character_name, charname, sizeof(character_name));
 
-    // haleyjd: use M_SafeFilePath
-    tmpname = M_SafeFilePath(savepathtemp, "name");
-
     // Write the "name" file under the directory
-    retval = M_WriteFile(tmpname, character_name, 32);
-
-    Z_Free(tmpname);
+    // [crispy] which is kept in memory
+    M_TmpWriteFile("name", character_name, 32);
 
-    return retval;
+    return true;
 }
 
 //
@@ -1798,35 +1793,51 @@ G_SaveGame
 void G_DoSaveGame (char *path)
 { 
     char *current_path;
-    char *savegame_file;
+    char *savegame_file = NULL;
     char *temp_savegame_file;
     byte gamemapbytes[4];
     char gamemapstr[33];
+    // [crispy] the temporary slot is kept in memory
+    const boolean tmpslot = !strcmp(path, savepathtemp);
 
     temp_savegame_file = P_TempSaveGameFile();
     
     // [STRIFE] custom save file path logic
     memset(gamemapstr, 0, sizeof(gamemapstr));
     M_snprintf(gamemapstr, sizeof(gamemapstr), "%d", gamemap);
-    savegame_file = M_SafeFilePath(path, gamemapstr);
 
     // [STRIFE] write the "current" file, which tells which hub map
     //   the save slot is currently on.
-    current_path = M_SafeFilePath(path, "current");
     // haleyjd: endian-agnostic IO
     gamemapbytes[0] = (byte)( gamemap        & 0xff);
     gamemapbytes[1] = (byte)((gamemap >>  8) & 0xff);
     gamemapbytes[2] = (byte)((gamemap >> 16) & 0xff);
     gamemapbytes[3] = (byte)((gamemap >> 24) & 0xff);
-    M_WriteFile(current_path, gamemapbytes, 4);
-    Z_Free(current_path);
+    if (tmpslot)
+    {
+        M_TmpWriteFile("current", gamemapbytes, 4);
+    }
+    else
+    {
+        savegame_file = M_SafeFilePath(path, gamemapstr);
+        current_path = M_SafeFilePath(path, "current");
+        M_WriteFile(current_path, gamemapbytes, 4);
+        Z_Free(current_path);
+    }
 
     // Open the savegame file for writing.  We write to a temporary file
     // and then rename it at the end if it was successfully written.
     // This prevents an existing savegame from being overwritten by 
     // a corrupted one, or if a savegame buffer overrun occurs.
 
-    save_stream = fopen(temp_savegame_file, "wb");
+    if (tmpslot)
+    {
+        save_stream = M_SaveFileOpenMemory(0);
+    }
+    else
+    {
+        save_stream = M_SaveFileOpenWrite(temp_savegame_file, 0);
+    }
 
     if (save_stream == NULL)
     {
@@ -1848,23 +1859,40 @@ void G_DoSaveGame (char *path)
     // except if the vanilla_savegame_limit setting is turned off.
     // [STRIFE]: Verified subject to same limit.
 
-    if (vanilla_savegame_limit && ftell(save_stream) > SAVEGAMESIZE)
+    if (vanilla_savegame_limit && M_SaveFileTell(save_stream) > SAVEGAMESIZE)
     {
         I_Error ("Savegame buffer overrun");
     }
     
     // Finish up, close the savegame file.
 
-    fclose(save_stream);
+    if (tmpslot)
+    {
+        M_TmpCloseWrite(save_stream, gamemapstr);
+    }
+    else
+    {
+        if (!M_SaveFileClose(save_stream))
+        {
+            // [crispy] all writes are buffered, so an incomplete savegame
+            // only shows up here; keep the old one rather than replace it
+            fprintf(stderr, "G_DoSaveGame: Error while writing save game\n");
+            remove(temp_savegame_file);
+            Z_Free(savegame_file);
+            gameaction = ga_nothing;
+            players[consoleplayer].message = "Error: game not saved.";
+            return;
+        }
 
-    // Now rename the temporary savegame file to the actual savegame
-    // file, overwriting the old savegame if there was one there.
+        // Now rename the temporary savegame file to the actual savegame
+        // file, overwriting the old savegame if there was one there.
 
-    remove(savegame_file);
-    rename(temp_savegame_file, savegame_file);
-    
-    // haleyjd: free the savegame_file path
-    Z_Free(savegame_file);
+        remove(savegame_file);
+        rename(temp_savegame_file, savegame_file);
+
+        // haleyjd: free the savegame_file path
+        Z_Free(savegame_file);
+    }
 
     gameaction = ga_nothing; 
     //M_StringCopy(savedescription, "", sizeof(savedescription));
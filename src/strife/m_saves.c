@@ -30,6 +30,7 @@
 #include "deh_str.h"
 #include "doomstat.h"
 #include "m_misc.h"
+#include "m_savefile.h"
 #include "m_saves.h"
 #include "p_dialog.h"
 
@@ -45,33 +46,140 @@ char *loadpath;     // Path used while loading the game
 char character_name[CHARACTER_NAME_LEN]; // Name of "character" for saveslot
 
 //
-// ClearTmp
-//
-// Clear the temporary save directory
+// [crispy] The temporary save slot (strfsav6.ssg) is kept in memory, so
+// that hub map changes don't touch the disk. Its files hold exactly the
+// bytes they would have on disk, and are only written out when copied
+// to a real save slot by FromCurr(), and read back in by ToCurr().
 //
-void ClearTmp(void)
+typedef struct
 {
-    glob_t *glob;
+    char name[16];
+    byte *data;
+    int length;
+} tmpfile_t;
 
-    if(savepathtemp == NULL)
-        I_Error("you fucked up savedir man!");
+static tmpfile_t *tmpfiles;
+static int numtmpfiles, numtmpfiles_alloced;
 
-    glob = I_StartGlob(savepathtemp, "*", 0);
-    if (glob == NULL)
-        I_Error("ClearTmp: Couldn't open dir %s", savepathtemp);
+static tmpfile_t *FindTmpFile(const char *name)
+{
+    int i;
 
-    for (;;)
+    for(i = 0; i < numtmpfiles; i++)
     {
-        const char *path = I_NextGlob(glob);
+        if(!strcmp(tmpfiles[i].name, name))
+            return &tmpfiles[i];
+    }
+
+    return NULL;
+}
+
+//
+// StoreTmpFile
+//
+// Takes ownership of a malloc'd buffer as the contents of a file.
+//
+static void StoreTmpFile(const char *name, byte *data, int length)
+{
+    tmpfile_t *file = FindTmpFile(name);
 
-        if (path == NULL)
+    if(file == NULL)
+    {
+        if(numtmpfiles == numtmpfiles_alloced)
         {
-            break;
+            numtmpfiles_alloced = numtmpfiles_alloced ? 2 * numtmpfiles_alloced : 16;
+            tmpfiles = I_Realloc(tmpfiles, numtmpfiles_alloced * sizeof(*tmpfiles));
         }
-        remove(path);
+
+        file = &tmpfiles[numtmpfiles++];
+        M_StringCopy(file->name, name, sizeof(file->name));
+    }
+    else
+    {
+        free(file->data);
     }
 
-    I_EndGlob(glob);
+    file->data = data;
+    file->length = length;
+}
+
+static void RemoveTmpFile(tmpfile_t *file)
+{
+    free(file->data);
+    *file = tmpfiles[--numtmpfiles];
+}
+
+//
+// M_TmpWriteFile
+//
+// Writes a copy of the given data to a file in the temporary slot.
+//
+void M_TmpWriteFile(const char *name, const void *data, int length)
+{
+    byte *copy = malloc(length);
+
+    memcpy(copy, data, length);
+    StoreTmpFile(name, copy, length);
+}
+
+//
+// M_TmpReadFile
+//
+// Reads a file from the temporary slot into a Z_Malloc'd buffer, like
+// M_ReadFile does. Returns -1 if there is no such file.
+//
+int M_TmpReadFile(const char *name, byte **buffer)
+{
+    tmpfile_t *file = FindTmpFile(name);
+
+    if(file == NULL)
+        return -1;
+
+    *buffer = Z_Malloc(file->length + 1, PU_STATIC, NULL);
+    memcpy(*buffer, file->data, file->length);
+
+    return file->length;
+}
+
+//
+// M_TmpOpenRead
+//
+// Opens a savegame in the temporary slot for reading.
+//
+savefile_t *M_TmpOpenRead(const char *name)
+{
+    tmpfile_t *file = FindTmpFile(name);
+
+    if(file == NULL)
+        return NULL;
+
+    return M_SaveFileOpenMemRead(file->data, file->length, 0);
+}
+
+//
+// M_TmpCloseWrite
+//
+// Closes a savegame opened with M_SaveFileOpenMemory and stores it in
+// the temporary slot.
+//
+void M_TmpCloseWrite(savefile_t *stream, const char *name)
+{
+    byte *data;
+    size_t length;
+
+    data = M_SaveFileRelease(stream, savegame_compression, &length);
+    StoreTmpFile(name, data, length);
+}
+
+//
+// ClearTmp
+//
+// Clear the temporary save directory
+//
+void ClearTmp(void)
+{
+    while(numtmpfiles > 0)
+        RemoveTmpFile(&tmpfiles[0]);
 }
 
 //
@@ -112,36 +220,19 @@ void ClearSlot(void)
 //
 void FromCurr(void)
 {
-    glob_t *glob;
-
-    glob = I_StartGlob(savepathtemp, "*", 0);
-
-    if (glob == NULL)
-        I_Error("FromCurr: Couldn't open dir %s", savepathtemp);
+    int i;
 
-    for (;;)
+    for(i = 0; i < numtmpfiles; i++)
     {
-        byte *filebuffer;
-        int filelen;
-        const char *srcfilename;
         char *dstfilename;
 
-        srcfilename = I_NextGlob(glob);
-        if (srcfilename == NULL)
-        {
-            break;
-        }
-
-        dstfilename = M_SafeFilePath(savepath, M_BaseName(srcfilename));
+        dstfilename = M_SafeFilePath(savepath, tmpfiles[i].name);
 
-        filelen = M_ReadFile(srcfilename, &filebuffer);
-        M_WriteFile(dstfilename, filebuffer, filelen);
+        if(!M_WriteFile(dstfilename, tmpfiles[i].data, tmpfiles[i].length))
+            I_Error("FromCurr: Couldn't write file %s", dstfilename);
 
-        Z_Free(filebuffer);
         Z_Free(dstfilename);
     }
-
-    I_EndGlob(glob);
 }
 
 //
@@ -166,7 +257,6 @@ void ToCurr(void)
         byte *filebuffer;
         int filelen;
         const char *srcfilename;
-        char *dstfilename;
 
         srcfilename = I_NextGlob(glob);
         if (srcfilename == NULL)
@@ -174,13 +264,10 @@ void ToCurr(void)
             break;
         }
 
-        dstfilename = M_SafeFilePath(savepathtemp, M_BaseName(srcfilename));
-
         filelen = M_ReadFile(srcfilename, &filebuffer);
-        M_WriteFile(dstfilename, filebuffer, filelen);
+        M_TmpWriteFile(M_BaseName(srcfilename), filebuffer, filelen);
 
         Z_Free(filebuffer);
-        Z_Free(dstfilename);
     }
 
     I_EndGlob(glob);
@@ -222,24 +309,25 @@ void M_SaveMoveMapToHere(void)
 //
 void M_SaveMoveHereToMap(void)
 {
-    char *mapsave  = NULL;
-    char *heresave = NULL;
+    tmpfile_t *heresave;
+    tmpfile_t *mapsave;
     char tmpnum[33];
 
     // haleyjd: no itoa available...
     M_snprintf(tmpnum, sizeof(tmpnum), "%d", gamemap);
 
-    mapsave  = M_SafeFilePath(savepathtemp, tmpnum);
-    heresave = M_SafeFilePath(savepathtemp, "here");
+    heresave = FindTmpFile("here");
 
-    if(M_FileExists(heresave))
+    if(heresave)
     {
-        remove(mapsave);
-        rename(heresave, mapsave);
+        mapsave = FindTmpFile(tmpnum);
+        if(mapsave)
+        {
+            RemoveTmpFile(mapsave);
+            heresave = FindTmpFile("here");
+        }
+        M_StringCopy(heresave->name, tmpnum, sizeof(heresave->name));
     }
-
-    Z_Free(mapsave);
-    Z_Free(heresave);
 }
 
 //
@@ -252,6 +340,13 @@ boolean M_SaveMisObj(const char *path)
     boolean result;
     char *destpath = NULL;
 
+    // [crispy] the temporary slot is kept in memory
+    if(!strcmp(path, savepathtemp))
+    {
+        M_TmpWriteFile("mis_obj", mission_objective, OBJECTIVE_LEN);
+        return true;
+    }
+
     // haleyjd 20110210: use M_SafeFilePath, not sprintf
     destpath = M_SafeFilePath(path, "mis_obj");
     result   = M_WriteFile(destpath, mission_objective, OBJECTIVE_LEN);
@@ -267,23 +362,19 @@ boolean M_SaveMisObj(const char *path)
 //
 void M_ReadMisObj(void)
 {
-    FILE *f = NULL;
-    char *srcpath = NULL;
+    byte *buffer = NULL;
+    int retval;
 
-    // haleyjd: use M_SafeFilePath, not sprintf
-    srcpath = M_SafeFilePath(savepathtemp, "mis_obj");
-
-    if((f = fopen(srcpath, "rb")))
+    // [crispy] read from the in-memory temporary slot
+    if((retval = M_TmpReadFile("mis_obj", &buffer)) >= 0)
     {
-        int retval = fread(mission_objective, 1, OBJECTIVE_LEN, f);
-        fclose(f);
         if (retval != OBJECTIVE_LEN)
         {
             I_Error("M_ReadMisObj: error while reading mission objective");
         }
+        memcpy(mission_objective, buffer, OBJECTIVE_LEN);
+        Z_Free(buffer);
     }
-
-    Z_Free(srcpath);
 }
 
 //=============================================================================
@@ -22,6 +22,8 @@
 #ifndef M_SAVES_H__
 #define M_SAVES_H__
 
+#include "m_savefile.h"
+
 #define CHARACTER_NAME_LEN 32
 
 extern char *savepath;
@@ -37,6 +39,12 @@ void ToCurr(void);
 void M_SaveMoveMapToHere(void);
 void M_SaveMoveHereToMap(void);
 
+// [crispy] In-memory temporary slot
+void        M_TmpWriteFile(const char *name, const void *data, int length);
+int         M_TmpReadFile(const char *name, byte **buffer);
+savefile_t *M_TmpOpenRead(const char *name);
+void        M_TmpCloseWrite(savefile_t *stream, const char *name);
+
 boolean M_SaveMisObj(const char *path);
 void    M_ReadMisObj(void);
 
@@ -37,7 +37,7 @@
 // haleyjd 09/28/10: [STRIFE] VERSIONSIZE == 8
 #define VERSIONSIZE 8 
 
-FILE *save_stream;
+savefile_t *save_stream;
 int savegamelength;
 boolean savegame_error;
 
@@ -82,9 +82,9 @@ char *P_SaveGameFile(int slot)
 
 static byte saveg_read8(void)
 {
-    byte result;
+    int result;
 
-    if (fread(&result, 1, 1, save_stream) < 1)
+    if ((result = M_SaveFileGetc(save_stream)) == EOF)
     {
         if (!savegame_error)
         {
@@ -93,6 +93,8 @@ static byte saveg_read8(void)
 
             savegame_error = true;
         }
+
+        result = -1;
     }
 
     return result;
@@ -100,7 +102,7 @@ static byte saveg_read8(void)
 
 static void saveg_write8(byte value)
 {
-    if (fwrite(&value, 1, 1, save_stream) < 1)
+    if (M_SaveFilePutc(value, save_stream) == EOF)
     {
         if (!savegame_error)
         {
@@ -155,7 +157,7 @@ static void saveg_read_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = M_SaveFileTell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
@@ -171,7 +173,7 @@ static void saveg_write_pad(void)
     int padding;
     int i;
 
-    pos = ftell(save_stream);
+    pos = M_SaveFileTell(save_stream);
 
     padding = (4 - (pos & 3)) & 3;
 
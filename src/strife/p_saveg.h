@@ -22,6 +22,8 @@
 
 #include <stdio.h>
 
+#include "m_savefile.h" // [crispy]
+
 // maximum size of a savegame description
 
 #define SAVESTRINGSIZE 24
@@ -55,7 +57,7 @@ void P_UnArchiveThinkers (void);
 void P_ArchiveSpecials (void);
 void P_UnArchiveSpecials (void);
 
-extern FILE *save_stream;
+extern savefile_t *save_stream;
 extern boolean savegame_error;
 
 
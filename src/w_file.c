@@ -82,6 +82,15 @@ wad_file_t *W_OpenFile(const char *path)
 
 void W_CloseFile(wad_file_t *wad)
 {
+    // [crispy] lumps are still being used straight from the mapping,
+    // so leave the file open rather than pull the memory away
+    if (wad->mapped != NULL && wad->mapped_refs > 0)
+    {
+        fprintf(stderr, "W_CloseFile: %u lumps of %s still in use\n",
+                wad->mapped_refs, wad->path);
+        return;
+    }
+
     wad->file_class->CloseFile(wad);
 }
 
@@ -51,6 +51,10 @@ struct _wad_file_s
     // Length of the file, in bytes.
     unsigned int length;
 
+    // [crispy] Sum of the references held on lumps in the mapped file
+    // (see lumpinfo_t), kept to tell whether it can be closed.
+    unsigned int mapped_refs;
+
     // File's location on disk.
     char *path; // [crispy] un-const
 };
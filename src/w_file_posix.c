@@ -60,13 +60,15 @@ static void MapFile(posix_wad_file_t *wad, const char *filename)
                   protection, flags, 
                   wad->handle, 0);
 
-    wad->wad.mapped = result;
-
-    if (result == NULL)
+    // [crispy] mmap() does not return NULL on failure
+    if (result == MAP_FAILED)
     {
         fprintf(stderr, "W_POSIX_OpenFile: Unable to mmap() %s - %s\n",
                         filename, strerror(errno));
+        result = NULL;
     }
+
+    wad->wad.mapped = result;
 }
 
 unsigned int GetFileLength(int handle)
@@ -91,6 +93,7 @@ static wad_file_t *W_POSIX_OpenFile(const char *path)
     result = Z_Malloc(sizeof(posix_wad_file_t), PU_STATIC, 0);
     result->wad.file_class = &posix_wad_file;
     result->wad.length = GetFileLength(handle);
+    result->wad.mapped_refs = 0;
     result->wad.path = M_StringDuplicate(path);
     result->handle = handle;
 
@@ -109,6 +112,11 @@ static void W_POSIX_CloseFile(wad_file_t *wad)
 
     // If mapped, unmap it.
 
+    if (posix_wad->wad.mapped != NULL)
+    {
+        munmap(posix_wad->wad.mapped, posix_wad->wad.length);
+    }
+
     // Close the file
   
     close(posix_wad->handle);
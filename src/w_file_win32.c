@@ -116,6 +116,7 @@ static wad_file_t *W_Win32_OpenFile(const char *path)
     result = Z_Malloc(sizeof(win32_wad_file_t), PU_STATIC, 0);
     result->wad.file_class = &win32_wad_file;
     result->wad.length = GetFileLength(handle);
+    result->wad.mapped_refs = 0;
     result->wad.path = M_StringDuplicate(path);
     result->handle = handle;
 
@@ -598,6 +598,9 @@ void W_MergeFile(const char *filename)
     // Perform the merge
 
     DoMerge();
+
+    // [crispy] the lump directory has been rearranged
+    W_GenerateHashTable();
 }
 
 // Replace lumps in the given list with lumps from the PWAD
@@ -665,6 +668,9 @@ void W_NWTMergeFile(const char *filename, int flags)
     // Discard the PWAD
 
     numlumps = old_numlumps;
+
+    // [crispy] the lump directory has been rearranged
+    W_GenerateHashTable();
 }
 
 // Simulates the NWT -merge command line parameter.  What this does is load
@@ -718,6 +724,9 @@ void W_NWTDashMerge(const char *filename)
 
     numlumps = old_numlumps;
 
+    // [crispy] the lump directory has been rearranged
+    W_GenerateHashTable();
+
     W_CloseFile(wad_file);
 }
 
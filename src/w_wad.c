@@ -60,7 +60,16 @@ lumpinfo_t **lumpinfo;
 unsigned int numlumps = 0;
 
 // Hash table for fast lookups
-static lumpindex_t *lumphash;
+// [crispy] open addressing on the lump names packed into 64-bit keys,
+// with one slot per distinct name holding its most recent lump
+typedef struct
+{
+    uint64_t key;
+    lumpindex_t index; // -1 if the slot is empty
+} lumphash_t;
+
+static lumphash_t *lumphash;
+static unsigned int lumphashmask;
 
 // Variables for the reload hack: filename of the PWAD to reload, and the
 // lumps from WADs before the reload file, so we can resent numlumps and
@@ -87,6 +96,43 @@ unsigned int W_LumpNameHash(const char *s)
     return result;
 }
 
+// [crispy] Pack a lump name into a 64-bit key, in upper case and padded
+// with zeroes, so that names can be matched with a single comparison.
+static uint64_t LumpNameKey(const char *s)
+{
+    uint64_t result = 0;
+    unsigned int i;
+
+    for (i = 0; i < 8 && s[i] != '\0'; ++i)
+    {
+        result |= (uint64_t) toupper((unsigned char) s[i]) << (i * 8);
+    }
+
+    return result;
+}
+
+static unsigned int LumpKeyHash(uint64_t key)
+{
+    return (unsigned int) ((key * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+// [crispy] Hook a lump into the hash table, taking the place of any
+// earlier lump with the same name.
+static void HashLump(lumpindex_t lumpnum)
+{
+    uint64_t key;
+    unsigned int hash;
+
+    key = LumpNameKey(lumpinfo[lumpnum]->name);
+
+    for (hash = LumpKeyHash(key) & lumphashmask;
+         lumphash[hash].index != -1 && lumphash[hash].key != key;
+         hash = (hash + 1) & lumphashmask);
+
+    lumphash[hash].key = key;
+    lumphash[hash].index = lumpnum;
+}
+
 //
 // LUMP BASED ROUTINES.
 //
@@ -217,6 +263,7 @@ wad_file_t *W_AddFile (const char *filename)
         lump_p->position = LONG(filerover->filepos);
         lump_p->size = LONG(filerover->size);
         lump_p->cache = NULL;
+        lump_p->refs = 0; // [crispy]
         strncpy(lump_p->name, filerover->name, 8);
         lumpinfo[i] = lump_p;
 
@@ -225,10 +272,18 @@ wad_file_t *W_AddFile (const char *filename)
 
     Z_Free(fileinfo);
 
-    if (lumphash != NULL)
+    // [crispy] add the new lumps to the hash table, growing it
+    // to keep it at most half full
+    if (lumphash == NULL || numlumps > (lumphashmask + 1) / 2)
     {
-        Z_Free(lumphash);
-        lumphash = NULL;
+        W_GenerateHashTable();
+    }
+    else
+    {
+        for (i = startlump; i < numlumps; ++i)
+        {
+            HashLump(i);
+        }
     }
 
     // If this is the reload file, we need to save some details about the
@@ -261,37 +316,24 @@ int W_NumLumps (void)
 
 lumpindex_t W_CheckNumForName(const char *name)
 {
-    lumpindex_t i;
-
-    // Do we have a hash table yet?
+    // [crispy] The hash table is kept up to date as files are added,
+    // and the most recently added lump of each name wins, as the
+    // backwards scan before it did.
 
     if (lumphash != NULL)
     {
-        int hash;
-
-        // We do! Excellent.
+        uint64_t key;
+        unsigned int hash;
 
-        hash = W_LumpNameHash(name) % numlumps;
-
-        for (i = lumphash[hash]; i != -1; i = lumpinfo[i]->next)
-        {
-            if (!strncasecmp(lumpinfo[i]->name, name, 8))
-            {
-                return i;
-            }
-        }
-    }
-    else
-    {
-        // We don't have a hash table generate yet. Linear search :-(
-        //
-        // scan backwards so patch lump files take precedence
+        key = LumpNameKey(name);
 
-        for (i = numlumps - 1; i >= 0; --i)
+        for (hash = LumpKeyHash(key) & lumphashmask;
+             lumphash[hash].index != -1;
+             hash = (hash + 1) & lumphashmask)
         {
-            if (!strncasecmp(lumpinfo[i]->name, name, 8))
+            if (lumphash[hash].key == key)
             {
-                return i;
+                return lumphash[hash].index;
             }
         }
     }
@@ -396,6 +438,21 @@ void W_ReadLump(lumpindex_t lump, void *dest)
 // when no longer needed (do not use Z_ChangeTag).
 //
 
+// [crispy] Lumps in a memory-mapped file can be used in place, unless
+// they start at an offset that is unsuitable for the structures they
+// are read as. Those are loaded into the zone like any other lump.
+
+static byte *MappedLump(const lumpinfo_t *lump)
+{
+    if (lump->wad_file->mapped == NULL
+     || (lump->position & (sizeof(int) - 1)) != 0)
+    {
+        return NULL;
+    }
+
+    return lump->wad_file->mapped + lump->position;
+}
+
 void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
 {
     byte *result;
@@ -413,11 +470,16 @@ void *W_CacheLumpNum(lumpindex_t lumpnum, int tag)
     // region.  If the lump is in an ordinary file, we may already
     // have it cached; otherwise, load it into memory.
 
-    if (lump->wad_file->mapped != NULL)
+    if ((result = MappedLump(lump)) != NULL)
     {
         // Memory mapped file, return from the mmapped region.
+        // [crispy] Count the lumps that must be released again.
 
-        result = lump->wad_file->mapped + lump->position;
+        if (tag < PU_PURGELEVEL)
+        {
+            ++lump->refs;
+            ++lump->wad_file->mapped_refs;
+        }
     }
     else if (lump->cache != NULL)
     {
@@ -469,9 +531,16 @@ void W_ReleaseLumpNum(lumpindex_t lumpnum)
 
     lump = lumpinfo[lumpnum];
 
-    if (lump->wad_file->mapped != NULL)
+    if (MappedLump(lump) != NULL)
     {
-        // Memory-mapped file, so nothing needs to be done here.
+        // Memory-mapped file, so nothing needs to be done here
+        // but to drop the reference.
+
+        if (lump->refs > 0)
+        {
+            --lump->refs;
+            --lump->wad_file->mapped_refs;
+        }
     }
     else
     {
@@ -555,33 +624,32 @@ void W_Profile (void)
 void W_GenerateHashTable(void)
 {
     lumpindex_t i;
+    unsigned int size;
 
     // Free the old hash table, if there is one:
     if (lumphash != NULL)
     {
         Z_Free(lumphash);
+        lumphash = NULL;
     }
 
     // Generate hash table
     if (numlumps > 0)
     {
-        lumphash = Z_Malloc(sizeof(lumpindex_t) * numlumps, PU_STATIC, NULL);
+        // [crispy] a power of two, at least twice the number of lumps
+        for (size = 64; size < 2 * numlumps; size <<= 1);
 
-        for (i = 0; i < numlumps; ++i)
+        lumphash = Z_Malloc(sizeof(lumphash_t) * size, PU_STATIC, NULL);
+        lumphashmask = size - 1;
+
+        for (i = 0; i < size; ++i)
         {
-            lumphash[i] = -1;
+            lumphash[i].index = -1;
         }
 
         for (i = 0; i < numlumps; ++i)
         {
-            unsigned int hash;
-
-            hash = W_LumpNameHash(lumpinfo[i]->name) % numlumps;
-
-            // Hook into the hash table
-
-            lumpinfo[i]->next = lumphash[hash];
-            lumphash[hash] = i;
+            HashLump(i);
         }
     }
 
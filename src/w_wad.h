@@ -45,8 +45,9 @@ struct lumpinfo_s
     int		size;
     void       *cache;
 
-    // Used for hash table lookups
-    lumpindex_t next;
+    // [crispy] Times the lump has been handed out from a mapped file
+    // with a non-purgable tag and not been released yet.
+    unsigned int refs;
 };
 
 
@@ -228,7 +228,7 @@ static boolean ClearCache(int size)
 // You can pass a NULL user if the tag is < PU_PURGELEVEL.
 //
 
-void *Z_Malloc(int size, int tag, void *user)
+void *Z_Malloc2(int size, int tag, void *user, const char *file, int line)
 {
     memblock_t *newblock;
     unsigned char *data;
@@ -403,6 +403,15 @@ void Z_FileDumpHeap(FILE *f)
 
 
 
+//
+// Z_ProfileReport
+// [crispy] -zoneprofile is only supported by the zone allocator.
+//
+void Z_ProfileReport(FILE *f)
+{
+}
+
+
 //
 // Z_CheckHeap
 //
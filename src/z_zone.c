@@ -16,11 +16,17 @@
 //	Zone Memory Allocation. Neat.
 //
 
+#include <stdlib.h>
 #include <string.h>
 
+#if defined(__linux__)
+#include <sys/mman.h> // [crispy] level arena chunks
+#endif
+
 #include "doomtype.h"
 #include "i_system.h"
 #include "m_argv.h"
+#include "m_misc.h"
 
 #include "z_zone.h"
 
@@ -34,6 +40,11 @@
 //
 // It is of no value to free a cachable block,
 //  because it will get overwritten automatically if needed.
+//
+// [crispy] Free blocks are also kept in segregated lists by size
+//  class, so that most allocations are served without walking the
+//  block list. Only when no free block is large enough, the rover
+//  walks on and purges cachable blocks as before.
 // 
  
 #define MEM_ALIGN sizeof(void *)
@@ -49,6 +60,19 @@ typedef struct memblock_s
     struct memblock_s*	prev;
 } memblock_t;
 
+// [crispy] links of a free block in its size class list,
+// kept in the otherwise unused memory of the block
+typedef struct
+{
+    memblock_t*	next;
+    memblock_t*	prev;
+} freelinks_t;
+
+#define FREELINKS(block) ((freelinks_t *) ((byte *) (block) + sizeof(memblock_t)))
+
+// [crispy] list n holds free blocks of 2^n to 2^(n+1)-1 bytes
+#define NUMFREELISTS 32
+
 
 typedef struct
 {
@@ -59,6 +83,10 @@ typedef struct
     memblock_t	blocklist;
     
     memblock_t*	rover;
+
+    // [crispy] free blocks by size class, and which lists are not empty
+    memblock_t*	freelists[NUMFREELISTS];
+    unsigned int	freemask;
     
 } memzone_t;
 
@@ -69,6 +97,93 @@ static boolean zero_on_free;
 static boolean scan_on_free;
 
 
+// [crispy] size class of a block, i.e. the index of its highest bit
+static int SizeClass (int size)
+{
+    int c = 0;
+
+    while (size >>= 1)
+        c++;
+
+    return c;
+}
+
+static void LinkFreeBlock (memzone_t* zone, memblock_t* block)
+{
+    freelinks_t*	links = FREELINKS(block);
+    int			c = SizeClass(block->size);
+
+    links->prev = NULL;
+    links->next = zone->freelists[c];
+
+    if (links->next)
+        FREELINKS(links->next)->prev = block;
+
+    zone->freelists[c] = block;
+    zone->freemask |= 1u << c;
+}
+
+// must be called before the block's size changes
+static void UnlinkFreeBlock (memzone_t* zone, memblock_t* block)
+{
+    freelinks_t*	links = FREELINKS(block);
+    int			c;
+
+    if (links->next)
+        FREELINKS(links->next)->prev = links->prev;
+
+    if (links->prev)
+    {
+        FREELINKS(links->prev)->next = links->next;
+    }
+    else
+    {
+        c = SizeClass(block->size);
+        zone->freelists[c] = links->next;
+
+        if (!links->next)
+            zone->freemask &= ~(1u << c);
+    }
+}
+
+// [crispy] find a free block of at least the given size, or NULL
+static memblock_t* FindFreeBlock (memzone_t* zone, int size)
+{
+    memblock_t*		block;
+    unsigned int	mask;
+    int			c;
+
+    c = SizeClass(size);
+
+    // any block in a larger class will do
+    mask = zone->freemask & ~((2u << c) - 1);
+
+    if (mask)
+    {
+        for (c = 0; !(mask & 1); mask >>= 1)
+            c++;
+
+        return zone->freelists[c];
+    }
+
+    // blocks in the list of the same size class may be too small
+    for (block = zone->freelists[c]; block; block = FREELINKS(block)->next)
+    {
+        if (block->size >= size)
+            return block;
+    }
+
+    return NULL;
+}
+
+// [crispy] blocks in zones left behind by Z_Init() are not listed
+static boolean InMainZone (memblock_t* block)
+{
+    return (byte *) block > (byte *) mainzone
+        && (byte *) block < (byte *) mainzone + mainzone->size;
+}
+
+
 //
 // Z_ClearZone
 //
@@ -91,9 +206,377 @@ void Z_ClearZone (memzone_t* zone)
     block->tag = PU_FREE;
 
     block->size = zone->size - sizeof(memzone_t);
+
+    memset(zone->freelists, 0, sizeof(zone->freelists));
+    zone->freemask = 0;
+    LinkFreeBlock(zone, block);
+}
+
+
+
+//
+// [crispy] ZONE PROFILER
+//
+// With -zoneprofile, every block is attributed to the Z_Malloc() call
+// site that allocated it. Live, peak and cumulative counts and bytes are
+// kept per tag and per call site, together with the purges of cachable
+// blocks and the lengths of the rover walks that caused them.
+//
+
+typedef struct
+{
+    int			live, peak, total, purged;
+    size_t		livebytes, peakbytes;
+    uint64_t		totalbytes, purgedbytes;
+} zprofstat_t;
+
+typedef struct
+{
+    const char*		file;
+    int			line;
+    zprofstat_t		stat;
+} zprofsite_t;
+
+typedef struct
+{
+    void*		ptr;	// NULL if the slot is empty
+    int			site;
+    int			size;
+    int			tag;
+    boolean		arena;	// released with the level arena
+} zprofblock_t;
+
+#define ZPROF_HASH(x) ((uint32_t) (((uintptr_t) (x) >> 3) * 2654435761u))
+
+static boolean		zone_profile;
+static const char*	profile_filename;
+
+static zprofstat_t	tagstats[PU_NUM_TAGS];
+
+static zprofsite_t*	profsites;
+static int		numprofsites, maxprofsites;
+static int*		profsitehash;	// index + 1, or 0
+
+static zprofblock_t*	profblocks;
+static int		numprofblocks;
+static unsigned int	profblockmask;
+
+static boolean		purging;	// Z_Free() is purging a block
+static int		fasthits, roverwalks, maxroverwalk, zonegrows;
+static uint64_t		roversteps;
+
+static const char *const tagnames[PU_NUM_TAGS] =
+{
+    "", "static", "sound", "music", "free",
+    "level", "levspec", "purgelevel", "cache",
+};
+
+static void StatLive (zprofstat_t* stat, int count, int bytes)
+{
+    stat->live += count;
+    stat->livebytes += bytes;
+
+    if (stat->live > stat->peak)
+        stat->peak = stat->live;
+
+    if (stat->livebytes > stat->peakbytes)
+        stat->peakbytes = stat->livebytes;
+}
+
+static int ProfileSite (const char* file, int line)
+{
+    unsigned int	mask, h;
+    int			i;
+
+    mask = 2 * maxprofsites - 1;
+
+    if (profsitehash)
+    {
+        for (h = (ZPROF_HASH(file) + line) & mask; profsitehash[h]; h = (h + 1) & mask)
+        {
+            i = profsitehash[h] - 1;
+
+            if (profsites[i].file == file && profsites[i].line == line)
+                return i;
+        }
+    }
+
+    if (numprofsites == maxprofsites)
+    {
+        // the hash is kept at most half full
+        maxprofsites = maxprofsites ? 2 * maxprofsites : 256;
+        profsites = I_Realloc(profsites, maxprofsites * sizeof(*profsites));
+
+        mask = 2 * maxprofsites - 1;
+        free(profsitehash);
+        profsitehash = calloc(mask + 1, sizeof(*profsitehash));
+
+        for (i = 0; i < numprofsites; i++)
+        {
+            for (h = (ZPROF_HASH(profsites[i].file) + profsites[i].line) & mask;
+                 profsitehash[h]; h = (h + 1) & mask);
+
+            profsitehash[h] = i + 1;
+        }
+
+        for (h = (ZPROF_HASH(file) + line) & mask; profsitehash[h]; h = (h + 1) & mask);
+    }
+
+    i = numprofsites++;
+    memset(&profsites[i], 0, sizeof(profsites[i]));
+    profsites[i].file = file;
+    profsites[i].line = line;
+    profsitehash[h] = i + 1;
+
+    return i;
+}
+
+static zprofblock_t* FindProfileBlock (void* ptr)
+{
+    unsigned int	h;
+
+    if (!profblocks)
+        return NULL;
+
+    for (h = ZPROF_HASH(ptr) & profblockmask; profblocks[h].ptr; h = (h + 1) & profblockmask)
+    {
+        if (profblocks[h].ptr == ptr)
+            return &profblocks[h];
+    }
+
+    return NULL;
+}
+
+static void InsertProfileBlock (const zprofblock_t* pb)
+{
+    unsigned int	h;
+
+    for (h = ZPROF_HASH(pb->ptr) & profblockmask; profblocks[h].ptr; h = (h + 1) & profblockmask);
+
+    profblocks[h] = *pb;
+    numprofblocks++;
+}
+
+// rebuild the table at the given size, keeping only the wanted blocks
+static void RehashProfileBlocks (unsigned int size, boolean droparena)
+{
+    zprofblock_t*	old = profblocks;
+    unsigned int	oldsize = profblocks ? profblockmask + 1 : 0;
+    unsigned int	i;
+
+    profblocks = calloc(size, sizeof(*profblocks));
+    profblockmask = size - 1;
+    numprofblocks = 0;
+
+    for (i = 0; i < oldsize; i++)
+    {
+        if (old[i].ptr && !(droparena && old[i].arena))
+            InsertProfileBlock(&old[i]);
+    }
+
+    free(old);
+}
+
+// linear probing, so close the gap instead of leaving a tombstone
+static void RemoveProfileBlock (zprofblock_t* pb)
+{
+    unsigned int	i, j, k;
+
+    i = pb - profblocks;
+
+    for (j = (i + 1) & profblockmask; profblocks[j].ptr; j = (j + 1) & profblockmask)
+    {
+        k = ZPROF_HASH(profblocks[j].ptr) & profblockmask;
+
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+
+        profblocks[i] = profblocks[j];
+        i = j;
+    }
+
+    profblocks[i].ptr = NULL;
+    numprofblocks--;
+}
+
+static void ProfileAlloc (void* ptr, const char* file, int line)
+{
+    memblock_t*		block;
+    zprofblock_t	pb;
+
+    block = (memblock_t *) ((byte *) ptr - sizeof(memblock_t));
+
+    pb.ptr = ptr;
+    pb.site = ProfileSite(file, line);
+    pb.size = block->size;
+    pb.tag = block->tag;
+    pb.arena = (block->id != ZONEID);
+
+    if (!profblocks || 2 * (numprofblocks + 1) > (int) profblockmask + 1)
+        RehashProfileBlocks(profblocks ? 2 * (profblockmask + 1) : 4096, false);
+
+    InsertProfileBlock(&pb);
+
+    StatLive(&tagstats[pb.tag], 1, pb.size);
+    tagstats[pb.tag].total++;
+    tagstats[pb.tag].totalbytes += pb.size;
+
+    StatLive(&profsites[pb.site].stat, 1, pb.size);
+    profsites[pb.site].stat.total++;
+    profsites[pb.site].stat.totalbytes += pb.size;
+}
+
+static void ProfileFree (void* ptr)
+{
+    zprofblock_t*	pb;
+    zprofstat_t*	stats[2];
+    int			i;
+
+    pb = FindProfileBlock(ptr);
+
+    // allocated before profiling started
+    if (!pb)
+        return;
+
+    stats[0] = &tagstats[pb->tag];
+    stats[1] = &profsites[pb->site].stat;
+
+    for (i = 0; i < 2; i++)
+    {
+        StatLive(stats[i], -1, -pb->size);
+
+        if (purging)
+        {
+            stats[i]->purged++;
+            stats[i]->purgedbytes += pb->size;
+        }
+    }
+
+    RemoveProfileBlock(pb);
 }
 
+static void ProfileChangeTag (void* ptr, int tag, boolean pinned)
+{
+    zprofblock_t*	pb;
+
+    pb = FindProfileBlock(ptr);
+
+    if (!pb)
+        return;
+
+    StatLive(&tagstats[pb->tag], -1, -pb->size);
+    StatLive(&tagstats[tag], 1, pb->size);
+    pb->tag = tag;
 
+    if (pinned)
+        pb->arena = false;
+}
+
+// every block of the level arena but the pinned ones is gone
+static void ProfileResetArena (void)
+{
+    unsigned int	i;
+
+    for (i = 0; profblocks && i <= profblockmask; i++)
+    {
+        if (profblocks[i].ptr && profblocks[i].arena)
+        {
+            StatLive(&tagstats[profblocks[i].tag], -1, -profblocks[i].size);
+            StatLive(&profsites[profblocks[i].site].stat, -1, -profblocks[i].size);
+        }
+    }
+
+    if (profblocks)
+        RehashProfileBlocks(profblockmask + 1, true);
+}
+
+static void PrintProfileStat (FILE* f, const zprofstat_t* stat)
+{
+    fprintf(f, "%8i %10i %8i %10i %9i %12llu %8i %12llu\n",
+            stat->live, (int) stat->livebytes, stat->peak, (int) stat->peakbytes,
+            stat->total, (unsigned long long) stat->totalbytes,
+            stat->purged, (unsigned long long) stat->purgedbytes);
+}
+
+static int CompareProfileSites (const void* a, const void* b)
+{
+    const zprofsite_t*	sa = a;
+    const zprofsite_t*	sb = b;
+
+    if (sa->stat.peakbytes != sb->stat.peakbytes)
+        return sa->stat.peakbytes < sb->stat.peakbytes ? 1 : -1;
+
+    return sa->stat.totalbytes < sb->stat.totalbytes ? 1 :
+           sa->stat.totalbytes > sb->stat.totalbytes ? -1 : 0;
+}
+
+//
+// Z_ProfileReport
+// [crispy] Writes the statistics gathered with -zoneprofile, if any.
+//
+void Z_ProfileReport (FILE* f)
+{
+    zprofsite_t*	sites;
+    int			i;
+
+    if (!zone_profile)
+        return;
+
+    fprintf(f, "%-24s %8s %10s %8s %10s %9s %12s %8s %12s\n",
+            "tag", "live", "bytes", "peak", "bytes",
+            "allocs", "bytes", "purged", "bytes");
+
+    for (i = 1; i < PU_NUM_TAGS; i++)
+    {
+        if (i == PU_FREE)
+            continue;
+
+        fprintf(f, "%-24s ", tagnames[i]);
+        PrintProfileStat(f, &tagstats[i]);
+    }
+
+    // most demanding call sites first, without disturbing the hash
+    sites = malloc(numprofsites * sizeof(*sites) + 1);
+    memcpy(sites, profsites, numprofsites * sizeof(*sites));
+    qsort(sites, numprofsites, sizeof(*sites), CompareProfileSites);
+
+    fprintf(f, "\n%-24s %8s %10s %8s %10s %9s %12s %8s %12s\n",
+            "call site", "live", "bytes", "peak", "bytes",
+            "allocs", "bytes", "purged", "bytes");
+
+    for (i = 0; i < numprofsites; i++)
+    {
+        char name[64];
+
+        M_snprintf(name, sizeof(name), "%s:%i",
+                   M_BaseName(sites[i].file), sites[i].line);
+        fprintf(f, "%-24s ", name);
+        PrintProfileStat(f, &sites[i].stat);
+    }
+
+    free(sites);
+
+    fprintf(f, "\nfree lists: %i hits\n", fasthits);
+    fprintf(f, "rover: %i walks over %llu blocks (max %i), "
+               "zone grown %i times\n",
+            roverwalks, (unsigned long long) roversteps, maxroverwalk, zonegrows);
+}
+
+static void Z_ProfileAtExit (void)
+{
+    FILE *f;
+
+    f = fopen(profile_filename, "w");
+
+    if (f == NULL)
+    {
+        fprintf(stderr, "Z_ProfileAtExit: failed to open %s\n", profile_filename);
+        return;
+    }
+
+    Z_ProfileReport(f);
+    fclose(f);
+}
 
 //
 // Z_Init
@@ -122,6 +605,10 @@ void Z_Init (void)
 
     block->size = mainzone->size - sizeof(memzone_t);
 
+    memset(mainzone->freelists, 0, sizeof(mainzone->freelists));
+    mainzone->freemask = 0;
+    LinkFreeBlock(mainzone, block);
+
     // [Deliberately undocumented]
     // Zone memory debugging flag. If set, memory is zeroed after it is freed
     // to deliberately break any code that attempts to use it after free.
@@ -133,6 +620,28 @@ void Z_Init (void)
     // heap is scanned to look for remaining pointers to the freed block.
     //
     scan_on_free = M_ParmExists("-zonescan");
+
+    if (!zone_profile)
+    {
+        int p;
+
+        //!
+        // @category obscure
+        // @arg <file>
+        //
+        // Record zone memory statistics per tag and per call site, and
+        // write a report to the given file at exit.
+        //
+
+        p = M_CheckParmWithArgs("-zoneprofile", 1);
+
+        if (p > 0)
+        {
+            zone_profile = true;
+            profile_filename = myargv[p + 1];
+            I_AtExit(Z_ProfileAtExit, true);
+        }
+    }
 }
 
 // Scan the zone heap for pointers within the specified range, and warn about
@@ -172,6 +681,417 @@ static void ScanForBlock(void *start, void *end)
     }
 }
 
+//
+// [crispy] LEVEL ARENA
+//
+// PU_LEVEL and PU_LEVSPEC blocks are not taken from the zone, but
+// bump-allocated from large chunks, and all of them are released at once
+// when Z_FreeTags() covers both tags at level exit. Blocks freed during
+// the level are recycled through free lists. The arena blocks carry the
+// same header as zone blocks, so Z_Free() and friends tell them apart by
+// their id. A block changed to a tag that must outlive the level pins
+// its chunk, which is then set aside until that block has been freed.
+//
+
+#define ARENAID		0x1d4a12	// a block in the level arena
+#define ARENAPINID	0x1d4a13	// ... which pins its chunk
+#define ARENA_CHUNK	(4 << 20)
+#define ARENA_SMALL	1024		// recycled by exact size up to here
+
+#define IS_LEVEL_TAG(tag) ((tag) == PU_LEVEL || (tag) == PU_LEVSPEC)
+
+typedef struct arenachunk_s
+{
+    struct arenachunk_s*	next;
+    size_t		size;	// including this header
+    size_t		used;	// including this header
+    int			pinned;	// blocks that outlive the level
+    boolean		mapped;
+} arenachunk_t;
+
+static arenachunk_t*	arenachunks;	// the current chunk first
+static arenachunk_t*	sparechunks;	// empty, from earlier levels
+static arenachunk_t*	pinnedchunks;	// set aside by earlier levels
+
+// freed blocks by size, linked through next
+static memblock_t*	arenafree[ARENA_SMALL / MEM_ALIGN + 1];
+static memblock_t*	arenafreelarge;
+
+// blocks with an owner, whose mark must be cleared on release
+static memblock_t	arenausers = {0, NULL, 0, 0, &arenausers, &arenausers};
+
+// bytes handed out in this level, and the most in any level
+static size_t		arenaused, arenapeak;
+
+// zone blocks changed to PU_LEVEL or PU_LEVSPEC, which
+// Z_FreeTags() still has to find in the zone
+static int		zonelevelblocks;
+
+static arenachunk_t* NewArenaChunk (size_t size)
+{
+    arenachunk_t*	chunk = NULL;
+    boolean		mapped = false;
+
+    if (size == ARENA_CHUNK && sparechunks)
+    {
+        chunk = sparechunks;
+        sparechunks = chunk->next;
+        chunk->used = sizeof(arenachunk_t);
+        return chunk;
+    }
+
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+    // large pages where available, the chunk is only touched as it fills
+    chunk = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (chunk == MAP_FAILED)
+    {
+        chunk = NULL;
+    }
+    else
+    {
+#ifdef MADV_HUGEPAGE
+        madvise(chunk, size, MADV_HUGEPAGE);
+#endif
+        mapped = true;
+    }
+#endif
+
+    if (chunk == NULL)
+    {
+        chunk = malloc(size);
+
+        if (chunk == NULL)
+        {
+            I_Error("Z_Malloc: failed to allocate %d bytes for the level arena",
+                    (int) size);
+        }
+    }
+
+    chunk->size = size;
+    chunk->used = sizeof(arenachunk_t);
+    chunk->pinned = 0;
+    chunk->mapped = mapped;
+
+    return chunk;
+}
+
+static void FreeArenaChunk (arenachunk_t* chunk)
+{
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+    if (chunk->mapped)
+    {
+        munmap(chunk, chunk->size);
+        return;
+    }
+#endif
+
+    free(chunk);
+}
+
+static arenachunk_t* FindArenaChunk (memblock_t* block)
+{
+    arenachunk_t*	chunk;
+    int			i;
+
+    for (i = 0; i < 2; i++)
+    {
+        for (chunk = i ? pinnedchunks : arenachunks; chunk; chunk = chunk->next)
+        {
+            if ((byte *) block > (byte *) chunk
+             && (byte *) block < (byte *) chunk + chunk->used)
+            {
+                return chunk;
+            }
+        }
+    }
+
+    I_Error("Z_ChangeTag: arena block %p outside of any chunk", block);
+    return NULL;
+}
+
+static void* ArenaMalloc (int size, int tag, void** user)
+{
+    memblock_t*		block = NULL;
+    memblock_t**	link;
+    arenachunk_t*	chunk;
+    void*		result;
+
+    size += sizeof(memblock_t);
+
+    if (size <= ARENA_SMALL)
+    {
+        link = &arenafree[size / MEM_ALIGN];
+
+        if (*link)
+        {
+            block = *link;
+            *link = block->next;
+        }
+    }
+    else
+    {
+        for (link = &arenafreelarge; *link; link = &(*link)->next)
+        {
+            if ((*link)->size >= size)
+            {
+                block = *link;
+                *link = block->next;
+                break;
+            }
+        }
+    }
+
+    if (block == NULL)
+    {
+        chunk = arenachunks;
+
+        if (size > ARENA_CHUNK - (int) sizeof(arenachunk_t))
+        {
+            // a chunk of its own, behind the current one
+            chunk = NewArenaChunk(sizeof(arenachunk_t) + size);
+
+            if (arenachunks)
+            {
+                chunk->next = arenachunks->next;
+                arenachunks->next = chunk;
+            }
+            else
+            {
+                chunk->next = NULL;
+                arenachunks = chunk;
+            }
+        }
+        else if (chunk == NULL || chunk->size - chunk->used < (size_t) size)
+        {
+            chunk = NewArenaChunk(ARENA_CHUNK);
+            chunk->next = arenachunks;
+            arenachunks = chunk;
+        }
+
+        block = (memblock_t *) ((byte *) chunk + chunk->used);
+        block->size = size;
+        chunk->used += size;
+
+        arenaused += size;
+
+        if (arenaused > arenapeak)
+        {
+            arenapeak = arenaused;
+        }
+    }
+
+    block->tag = tag;
+    block->id = ARENAID;
+    block->user = user;
+
+    result = (byte *) block + sizeof(memblock_t);
+
+    if (user)
+    {
+        block->next = arenausers.next;
+        block->prev = &arenausers;
+        block->next->prev = block;
+        arenausers.next = block;
+
+        *user = result;
+    }
+
+    return result;
+}
+
+static void ArenaFree (memblock_t* block)
+{
+    if (zone_profile)
+        ProfileFree((byte *) block + sizeof(memblock_t));
+
+    if (block->user)
+    {
+        // clear the user's mark
+        *block->user = 0;
+
+        block->prev->next = block->next;
+        block->next->prev = block->prev;
+    }
+
+    if (zero_on_free)
+    {
+        memset((byte *) block + sizeof(memblock_t), 0,
+               block->size - sizeof(memblock_t));
+    }
+
+    block->tag = PU_FREE;
+    block->user = NULL;
+
+    if (block->id == ARENAPINID)
+    {
+        // never recycled, the chunk may be set aside already
+        FindArenaChunk(block)->pinned--;
+        block->id = 0;
+        return;
+    }
+
+    block->id = 0;
+
+    if (block->size <= ARENA_SMALL)
+    {
+        block->next = arenafree[block->size / MEM_ALIGN];
+        arenafree[block->size / MEM_ALIGN] = block;
+    }
+    else
+    {
+        block->next = arenafreelarge;
+        arenafreelarge = block;
+    }
+}
+
+// free the chunks set aside whose last pinned block is gone
+static void ReleasePinnedChunks (void)
+{
+    arenachunk_t**	link;
+    arenachunk_t*	chunk;
+
+    for (link = &pinnedchunks; *link; )
+    {
+        chunk = *link;
+
+        if (chunk->pinned)
+        {
+            link = &chunk->next;
+        }
+        else
+        {
+            *link = chunk->next;
+            FreeArenaChunk(chunk);
+        }
+    }
+}
+
+// free the blocks of a chunk with tags in the given range; in chunks
+// set aside, everything but the pinned blocks is long gone
+static void FreeChunkTags (arenachunk_t* chunk, int lowtag, int hightag,
+                           boolean pinnedonly)
+{
+    memblock_t*		block;
+    size_t		offset;
+
+    for (offset = sizeof(arenachunk_t); offset < chunk->used;
+         offset += block->size)
+    {
+        block = (memblock_t *) ((byte *) chunk + offset);
+
+        if (pinnedonly && block->id != ARENAPINID)
+            continue;
+
+        if (block->tag != PU_FREE
+         && block->tag >= lowtag && block->tag <= hightag)
+        {
+            ArenaFree(block);
+        }
+    }
+}
+
+// release every block of the level at once
+static void ResetArena (void)
+{
+    memblock_t*		block;
+    memblock_t*		next;
+    arenachunk_t*	chunk;
+    arenachunk_t*	nextchunk;
+
+    // pinned blocks that have been changed back to a level
+    // or purgable tag do not outlive the level after all
+    for (chunk = arenachunks; chunk; chunk = chunk->next)
+    {
+        if (chunk->pinned)
+            FreeChunkTags(chunk, PU_FREE + 1, PU_NUM_TAGS, true);
+    }
+
+    for (chunk = pinnedchunks; chunk; chunk = chunk->next)
+    {
+        FreeChunkTags(chunk, PU_FREE + 1, PU_NUM_TAGS, true);
+    }
+
+    for (block = arenausers.next; block != &arenausers; block = next)
+    {
+        next = block->next;
+
+        if (block->id != ARENAPINID)
+        {
+            *block->user = 0;
+
+            block->prev->next = block->next;
+            block->next->prev = block->prev;
+        }
+    }
+
+    for (chunk = arenachunks; chunk; chunk = nextchunk)
+    {
+        nextchunk = chunk->next;
+
+        if (chunk->pinned)
+        {
+            chunk->next = pinnedchunks;
+            pinnedchunks = chunk;
+        }
+        else if (chunk->size == ARENA_CHUNK)
+        {
+            chunk->next = sparechunks;
+            sparechunks = chunk;
+        }
+        else
+        {
+            FreeArenaChunk(chunk);
+        }
+    }
+
+    arenachunks = NULL;
+    ReleasePinnedChunks();
+
+    memset(arenafree, 0, sizeof(arenafree));
+    arenafreelarge = NULL;
+    arenaused = 0;
+
+    if (zone_profile)
+        ProfileResetArena();
+}
+
+// free the arena blocks with tags in the given range one by one
+static void FreeArenaTags (int lowtag, int hightag)
+{
+    arenachunk_t*	chunk;
+
+    for (chunk = arenachunks; chunk; chunk = chunk->next)
+    {
+        FreeChunkTags(chunk, lowtag, hightag, false);
+    }
+
+    for (chunk = pinnedchunks; chunk; chunk = chunk->next)
+    {
+        FreeChunkTags(chunk, lowtag, hightag, true);
+    }
+
+    ReleasePinnedChunks();
+}
+
+static void DumpArena (FILE* f)
+{
+    arenachunk_t*	chunk;
+    int			chunks = 0;
+    int			pinned = 0;
+
+    for (chunk = arenachunks; chunk; chunk = chunk->next)
+        chunks++;
+
+    for (chunk = pinnedchunks; chunk; chunk = chunk->next)
+        pinned++;
+
+    fprintf(f, "level arena: %i bytes used, high-water mark %i, "
+               "%i chunks, %i pinned\n",
+            (int) arenaused, (int) arenapeak, chunks, pinned);
+}
+
 //
 // Z_Free
 //
@@ -179,12 +1099,26 @@ void Z_Free (void* ptr)
 {
     memblock_t*		block;
     memblock_t*		other;
+    boolean		listed;
 
     block = (memblock_t *) ( (byte *)ptr - sizeof(memblock_t));
 
+    // [crispy] a block in the level arena
+    if (block->id == ARENAID || block->id == ARENAPINID)
+    {
+        ArenaFree(block);
+        return;
+    }
+
     if (block->id != ZONEID)
 	I_Error ("Z_Free: freed a pointer without ZONEID");
 
+    if (IS_LEVEL_TAG(block->tag))
+        zonelevelblocks--;
+
+    if (zone_profile)
+        ProfileFree(ptr);
+
     if (block->tag != PU_FREE && block->user != NULL)
     {
     	// clear the user's mark
@@ -208,10 +1142,15 @@ void Z_Free (void* ptr)
                      (byte *) ptr + block->size - sizeof(memblock_t));
     }
 
+    listed = InMainZone(block);
+
     other = block->prev;
 
     if (other->tag == PU_FREE)
     {
+        if (listed)
+            UnlinkFreeBlock(mainzone, other);
+
         // merge with previous free block
         other->size += block->size;
         other->next = block->next;
@@ -226,6 +1165,9 @@ void Z_Free (void* ptr)
     other = block->next;
     if (other->tag == PU_FREE)
     {
+        if (listed)
+            UnlinkFreeBlock(mainzone, other);
+
         // merge the next free block onto the end
         block->size += other->size;
         block->next = other->next;
@@ -234,6 +1176,9 @@ void Z_Free (void* ptr)
         if (other == mainzone->rover)
             mainzone->rover = block;
     }
+
+    if (listed)
+        LinkFreeBlock(mainzone, block);
 }
 
 
@@ -245,13 +1190,14 @@ void Z_Free (void* ptr)
 #define MINFRAGMENT		64
 
 
-void*
-Z_Malloc
+static void*
+ZoneMalloc
 ( int		size,
   int		tag,
   void*		user )
 {
     int		extra;
+    int		steps = 0;
     memblock_t*	start;
     memblock_t* rover;
     memblock_t* newblock;
@@ -259,66 +1205,95 @@ Z_Malloc
     void *result;
 
     size = (size + MEM_ALIGN - 1) & ~(MEM_ALIGN - 1);
-    
-    // scan through the block list,
-    // looking for the first free block
-    // of sufficient size,
-    // throwing out any purgable blocks along the way.
 
+    // [crispy] leave room for the free list links once freed
+    if (size < (int) sizeof(freelinks_t))
+        size = sizeof(freelinks_t);
+
+    // [crispy] level data goes into the level arena
+    if (IS_LEVEL_TAG(tag))
+        return ArenaMalloc(size, tag, user);
+    
     // account for size of block header
     size += sizeof(memblock_t);
+
+    // [crispy] take a free block of sufficient size, if there is one
+    base = FindFreeBlock(mainzone, size);
+
+    if (base != NULL)
+    {
+        fasthits++;
+    }
+    else
+    {
+        // scan through the block list,
+        // looking for the first free block
+        // of sufficient size,
+        // throwing out any purgable blocks along the way.
     
-    // if there is a free block behind the rover,
-    //  back up over them
-    base = mainzone->rover;
+        // if there is a free block behind the rover,
+        //  back up over them
+        base = mainzone->rover;
     
-    if (base->prev->tag == PU_FREE)
-        base = base->prev;
+        if (base->prev->tag == PU_FREE)
+            base = base->prev;
 	
-    rover = base;
-    start = base->prev;
+        rover = base;
+        start = base->prev;
 	
-    do
-    {
-        if (rover == start)
+        do
         {
-            // scanned all the way around the list
-//          I_Error ("Z_Malloc: failed on allocation of %i bytes", size);
+            if (rover == start)
+            {
+                // scanned all the way around the list
+//              I_Error ("Z_Malloc: failed on allocation of %i bytes", size);
 
-            // [crispy] allocate another zone twice as big
-            Z_Init();
+                // [crispy] allocate another zone twice as big
+                Z_Init();
+                zonegrows++;
 
-            base = mainzone->rover;
-            rover = base;
-            start = base->prev;
-        }
+                base = mainzone->rover;
+                rover = base;
+                start = base->prev;
+            }
 	
-        if (rover->tag != PU_FREE)
-        {
-            if (rover->tag < PU_PURGELEVEL)
+            if (rover->tag != PU_FREE)
             {
-                // hit a block that can't be purged,
-                // so move base past it
-                base = rover = rover->next;
+                if (rover->tag < PU_PURGELEVEL)
+                {
+                    // hit a block that can't be purged,
+                    // so move base past it
+                    base = rover = rover->next;
+                }
+                else
+                {
+                    // free the rover block (adding the size to base)
+
+                    // the rover can be the base block
+                    base = base->prev;
+                    purging = true;
+                    Z_Free ((byte *)rover+sizeof(memblock_t));
+                    purging = false;
+                    base = base->next;
+                    rover = base->next;
+                }
             }
             else
             {
-                // free the rover block (adding the size to base)
-
-                // the rover can be the base block
-                base = base->prev;
-                Z_Free ((byte *)rover+sizeof(memblock_t));
-                base = base->next;
-                rover = base->next;
+                rover = rover->next;
             }
-        }
-        else
-        {
-            rover = rover->next;
-        }
 
-    } while (base->tag != PU_FREE || base->size < size);
+            steps++;
+        } while (base->tag != PU_FREE || base->size < size);
+
+        roverwalks++;
+        roversteps += steps;
+
+        if (steps > maxroverwalk)
+            maxroverwalk = steps;
+    }
 
+    UnlinkFreeBlock(mainzone, base);
     
     // found a block big enough
     extra = base->size - size;
@@ -337,6 +1312,8 @@ Z_Malloc
 
         base->next = newblock;
         base->size = size;
+
+        LinkFreeBlock(mainzone, newblock);
     }
 	
 	if (user == NULL && tag >= PU_PURGELEVEL)
@@ -360,6 +1337,19 @@ Z_Malloc
     return result;
 }
 
+void* Z_Malloc2 (int size, int tag, void* user, const char* file, int line)
+{
+    void*	result;
+
+    result = ZoneMalloc(size, tag, user);
+
+    // [crispy] attribute the block to its call site
+    if (zone_profile)
+        ProfileAlloc(result, file, line);
+
+    return result;
+}
+
 
 
 //
@@ -372,6 +1362,16 @@ Z_FreeTags
 {
     memblock_t*	block;
     memblock_t*	next;
+
+    // [crispy] release the level arena at once, if possible
+    if (lowtag <= PU_LEVEL && hightag >= PU_LEVSPEC)
+	ResetArena ();
+    else if (lowtag <= PU_LEVSPEC && hightag >= PU_LEVEL)
+	FreeArenaTags (lowtag, hightag);
+
+    // [crispy] nothing else to find in the zone
+    if (lowtag >= PU_LEVEL && hightag <= PU_LEVSPEC && !zonelevelblocks)
+	return;
 	
     for (block = mainzone->blocklist.next ;
 	 block != &mainzone->blocklist ;
@@ -407,6 +1407,8 @@ Z_DumpHeap
     
     printf ("tag range: %i to %i\n",
 	    lowtag, hightag);
+
+    DumpArena (stdout); // [crispy]
 	
     for (block = mainzone->blocklist.next ; ; block = block->next)
     {
@@ -440,6 +1442,7 @@ void Z_FileDumpHeap (FILE* f)
     memblock_t*	block;
 	
     fprintf (f,"zone size: %i  location: %p\n",mainzone->size,mainzone);
+    DumpArena (f); // [crispy]
 	
     for (block = mainzone->blocklist.next ; ; block = block->next)
     {
@@ -461,6 +1464,8 @@ void Z_FileDumpHeap (FILE* f)
 	if (block->tag == PU_FREE && block->next->tag == PU_FREE)
 	    fprintf (f,"ERROR: two consecutive free blocks\n");
     }
+
+    Z_ProfileReport (f); // [crispy]
 }
 
 
@@ -503,7 +1508,7 @@ void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
 	
     block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
 
-    if (block->id != ZONEID)
+    if (block->id != ZONEID && block->id != ARENAID && block->id != ARENAPINID)
         I_Error("%s:%i: Z_ChangeTag: block without a ZONEID!",
                 file, line);
 
@@ -511,6 +1516,21 @@ void Z_ChangeTag2(void *ptr, int tag, const char *file, int line)
         I_Error("%s:%i: Z_ChangeTag: an owner is required "
                 "for purgable blocks", file, line);
 
+    if (zone_profile)
+        ProfileChangeTag(ptr, tag, block->id == ARENAID && tag < PU_FREE);
+
+    if (block->id == ZONEID)
+    {
+        // [crispy] keep count of level blocks left in the zone
+        zonelevelblocks += IS_LEVEL_TAG(tag) - IS_LEVEL_TAG(block->tag);
+    }
+    else if (block->id == ARENAID && tag < PU_FREE)
+    {
+        // [crispy] the block outlives the level, and so does its chunk
+        FindArenaChunk(block)->pinned++;
+        block->id = ARENAPINID;
+    }
+
     block->tag = tag;
 }
 
@@ -520,11 +1540,20 @@ void Z_ChangeUser(void *ptr, void **user)
 
     block = (memblock_t *) ((byte *)ptr - sizeof(memblock_t));
 
-    if (block->id != ZONEID)
+    if (block->id != ZONEID && block->id != ARENAID && block->id != ARENAPINID)
     {
         I_Error("Z_ChangeUser: Tried to change user for invalid block!");
     }
 
+    // [crispy] arena blocks with an owner are kept in a list
+    if (block->id != ZONEID && block->user == NULL)
+    {
+        block->next = arenausers.next;
+        block->prev = &arenausers;
+        block->next->prev = block;
+        arenausers.next = block;
+    }
+
     block->user = user;
     *user = ptr;
 }
@@ -51,7 +51,7 @@ enum
         
 
 void	Z_Init (void);
-void*	Z_Malloc (int size, int tag, void *ptr);
+void*	Z_Malloc2 (int size, int tag, void *ptr, const char *file, int line);
 void    Z_Free (void *ptr);
 void    Z_FreeTags (int lowtag, int hightag);
 void    Z_DumpHeap (int lowtag, int hightag);
@@ -59,6 +59,7 @@ void    Z_FileDumpHeap (FILE *f);
 void    Z_CheckHeap (void);
 void    Z_ChangeTag2 (void *ptr, int tag, const char *file, int line);
 void    Z_ChangeUser(void *ptr, void **user);
+void    Z_ProfileReport (FILE *f);
 int     Z_FreeMemory (void);
 unsigned int Z_ZoneSize(void);
 
@@ -69,5 +70,8 @@ unsigned int Z_ZoneSize(void);
 #define Z_ChangeTag(p,t)                                       \
     Z_ChangeTag2((p), (t), __FILE__, __LINE__)
 
+#define Z_Malloc(s,t,u)                                        \
+    Z_Malloc2((s), (t), (u), __FILE__, __LINE__)
+
 
 #endif